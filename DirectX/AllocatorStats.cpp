@@ -0,0 +1,20 @@
+#include "AllocatorStats.h"
+
+AllocatorStats::AllocatorStats(const char* name)
+	:
+	name(name)
+{
+	GetAll().push_back(this);
+}
+
+float AllocatorStats::GetFragmentation() {
+	if (reservedBytes == 0) {
+		return 0;
+	}
+	return 1.0f - (float)liveBytes / (float)reservedBytes;
+}
+
+std::vector<AllocatorStats*>& AllocatorStats::GetAll() {
+	static std::vector<AllocatorStats*> all;
+	return all;
+}
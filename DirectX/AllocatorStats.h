@@ -0,0 +1,23 @@
+#ifndef H_ALLOCATORSTATS
+#define H_ALLOCATORSTATS
+#include <vector>
+#include <cstddef>
+
+// Counters every engine allocator keeps about itself. Instances register
+// themselves on construction so the Gui can list them.
+struct AllocatorStats {
+	AllocatorStats(const char* name);
+
+	const char* name;
+	size_t allocationCount = 0;		// Allocations served since startup
+	size_t freeCount = 0;			// Frees since startup
+	size_t heapAllocationCount = 0;	// Blocks requested from the global heap
+	size_t liveBytes = 0;
+	size_t reservedBytes = 0;
+
+	// Share of the reserved memory that is not in use
+	float GetFragmentation();
+
+	static std::vector<AllocatorStats*>& GetAll();
+};
+#endif
@@ -1,13 +1,44 @@
+#include <algorithm>
 #include "Camera.h"
 #include "btBulletDynamicsCommon.h"
 #include "GameObject.h"
+#include "Game.h"
+#include "Graphics.h"
+#include "Window.h"
+#include "TransformHierarchy.h"
 
 Camera::Camera(GameObject* gameObject)
 	:
-	Component(gameObject)
+	Component(gameObject),
+	viewMatrix(dx::XMMatrixIdentity()),
+	projectionMatrix(dx::XMMatrixIdentity()),
+	viewportHeight(0)
 {}
 
+Camera::~Camera() {
+	if (Game::GetInstance()->GetMainCamera() == this) {
+		Game::GetInstance()->SetMainCamera(nullptr);
+	}
+}
+
 dx::XMMATRIX Camera::GetMatrix() {
+	return viewMatrix;
+}
+
+dx::XMMATRIX Camera::GetProjectionMatrix() {
+	return projectionMatrix;
+}
+
+float Camera::GetPixelsPerUnit(const dx::BoundingBox& bounds) {
+	dx::XMVECTOR center = dx::XMVector3TransformCoord(dx::XMLoadFloat3(&bounds.Center), viewMatrix);
+	float radius = dx::XMVectorGetX(dx::XMVector3Length(dx::XMLoadFloat3(&bounds.Extents)));
+
+	// Bounds the camera is in are as close as anything can get
+	float depth = std::max(dx::XMVectorGetZ(center) - radius, Graphics::GetInstance()->GetNearZ());
+	return dx::XMVectorGetY(projectionMatrix.r[1]) * viewportHeight / (2.0f * depth);
+}
+
+dx::XMMATRIX Camera::ComputeViewMatrix() {
 	btTransform transform = gameObject->GetTransform();
 	dx::XMVECTOR cameraPosition = dx::XMVectorSet(
 		transform.getOrigin().x(),
@@ -31,4 +62,22 @@ dx::XMMATRIX Camera::GetMatrix() {
 	return dx::XMMatrixLookAtLH(cameraPosition, cameraPosition + lookVector, XMVectorSet(0, 1, 0, 0));
 }
 
-void Camera::Update() {}
+void Camera::Update() {
+	if (Game::GetInstance()->GetMainCamera() != this) {
+		return;
+	}
+
+	RECT clientRect;
+	GetClientRect(Window::GetInstance()->GetHandle(), &clientRect);
+	float squeeze = (float)clientRect.bottom / (float)clientRect.right;
+	viewportHeight = (float)clientRect.bottom;
+
+	viewMatrix = ComputeViewMatrix();
+	projectionMatrix = dx::XMMatrixPerspectiveLH(1.0f, squeeze, Graphics::GetInstance()->GetNearZ(), Graphics::GetInstance()->GetFarZ());
+
+	// The shadow map is drawn with the projection alone, so its frustum stays in world space
+	dx::BoundingFrustum shadowFrustum(projectionMatrix);
+	shadowFrustum.Transform(frustum, dx::XMMatrixInverse(nullptr, viewMatrix));
+
+	TransformHierarchy::GetInstance()->Cull(frustum, shadowFrustum);
+}
@@ -2,15 +2,36 @@
 #define H_CAMERA
 #include "Component.h"
 #include "Main.h"
+#include <DirectXCollision.h>
 
 using namespace dx;
 
 class Camera : public Component {
 public:
 	Camera(GameObject* gameObject);
+	~Camera();
 
+	// Both are computed once per frame in Update
 	dx::XMMATRIX GetMatrix();
+	dx::XMMATRIX GetProjectionMatrix();
+
+	// Screen pixels covered by one world unit at the nearest point of the bounds
+	float GetPixelsPerUnit(const dx::BoundingBox& bounds);
+
+	static const ComponentType TYPE = COMPONENT_TYPE_CAMERA;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+	static const int UPDATE_ORDER = UPDATE_ORDER_CAMERA;
+	static const AccessMask READS = ACCESS_TRANSFORM;
+	static const AccessMask WRITES = ACCESS_VISIBILITY;
+	static const bool PARALLEL_UPDATE = true;
 
 	void Update() override;
+private:
+	dx::XMMATRIX viewMatrix;
+	dx::XMMATRIX projectionMatrix;
+	float viewportHeight;
+	dx::BoundingFrustum frustum;
+
+	dx::XMMATRIX ComputeViewMatrix();
 };
 #endif
@@ -12,5 +12,21 @@ Clock Clock::GetSingleton() {
 }
 
 float Clock::GetTimeSinceStart() {
+	if (manualTimeEnabled) {
+		return manualTime;
+	}
+	return GetRealTimeSinceStart();
+}
+
+float Clock::GetRealTimeSinceStart() {
 	return std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
 }
+
+void Clock::SetManualTime(float seconds) {
+	manualTimeEnabled = true;
+	manualTime = seconds;
+}
+
+void Clock::ClearManualTime() {
+	manualTimeEnabled = false;
+}
@@ -7,9 +7,18 @@ public:
 	static Clock GetSingleton();
 
 	float GetTimeSinceStart();
+	// Ignores the manual time
+	float GetRealTimeSinceStart();
+
+	// Replays pin the time to the recorded frame times so every run sees the same deltas
+	static void SetManualTime(float seconds);
+	static void ClearManualTime();
 private:
 	Clock();
 
+	inline static bool manualTimeEnabled = false;
+	inline static float manualTime = 0.0f;
+
 	std::chrono::steady_clock::time_point startTime;
 };
 #endif
\ No newline at end of file
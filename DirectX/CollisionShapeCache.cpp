@@ -0,0 +1,228 @@
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <Windows.h>
+#include "CollisionShapeCache.h"
+#include "Graphics.h"
+
+// Precedes the tree in a BVH file, a tree saved by a build with another
+// btScalar or from other geometry is built again
+struct BvhFileHeader {
+	char magic[4];
+	uint32_t scalarSize;
+	uint64_t geometryHash;
+	uint32_t bvhSize;
+	uint32_t reserved;
+};
+
+static const char BVH_MAGIC[4] = { 'B', 'V', 'H', '1' };
+
+CollisionShapeCache* CollisionShapeCache::GetInstance() {
+	if (!instance) {
+		instance = new CollisionShapeCache();
+	}
+	return instance;
+}
+
+CollisionShapeCache::CollisionShapeCache()
+{}
+
+btCollisionShape* CollisionShapeCache::AcquireBox(btVector3 halfExtents) {
+	ShapeKey key(BOX_SHAPE_PROXYTYPE, 0, halfExtents.x(), halfExtents.y(), halfExtents.z());
+	auto found = shapes.find(key);
+	if (found != shapes.end()) {
+		found->second.refCount++;
+		return found->second.shape;
+	}
+
+	btCollisionShape* shape = new btBoxShape(halfExtents);
+	shapes[key] = { shape, 1, nullptr };
+	keys[shape] = key;
+	return shape;
+}
+
+btCollisionShape* CollisionShapeCache::AcquireConvexHull(const VERTEX* vertices, int vertexCount, btVector3 scale) {
+	uint64_t hash = HashGeometry(vertices, vertexCount, nullptr, 0);
+	ShapeKey key(CONVEX_HULL_SHAPE_PROXYTYPE, hash, scale.x(), scale.y(), scale.z());
+	auto found = shapes.find(key);
+	if (found != shapes.end()) {
+		found->second.refCount++;
+		return found->second.shape;
+	}
+
+	btConvexHullShape* shape = new btConvexHullShape();
+	for (int i = 0; i < vertexCount; i++) {
+		shape->addPoint(btVector3(vertices[i].position[0], vertices[i].position[1], vertices[i].position[2]), false);
+	}
+	shape->recalcLocalAabb();
+	shape->setLocalScaling(scale);
+
+	shapes[key] = { shape, 1, nullptr };
+	keys[shape] = key;
+	return shape;
+}
+
+btCollisionShape* CollisionShapeCache::AcquireTriangleMesh(const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount, btVector3 scale) {
+	uint64_t hash = HashGeometry(vertices, vertexCount, indices, indexCount);
+	ShapeKey key(SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE, hash, scale.x(), scale.y(), scale.z());
+	auto found = shapes.find(key);
+	if (found != shapes.end()) {
+		found->second.refCount++;
+		return found->second.shape;
+	}
+
+	// Every scale shares the unscaled mesh and its tree
+	TriangleMesh* mesh = AcquireMesh(hash, vertices, vertexCount, indices, indexCount);
+	btCollisionShape* shape = new btScaledBvhTriangleMeshShape(mesh->shape, scale);
+
+	shapes[key] = { shape, 1, mesh };
+	keys[shape] = key;
+	return shape;
+}
+
+void CollisionShapeCache::Release(btCollisionShape* shape) {
+	auto key = keys.find(shape);
+	auto found = shapes.find(key->second);
+	found->second.refCount--;
+	if (found->second.refCount == 0) {
+		TriangleMesh* mesh = found->second.mesh;
+		shapes.erase(found);
+		keys.erase(key);
+		delete shape;
+
+		if (mesh) {
+			ReleaseMesh(mesh);
+		}
+	}
+}
+
+CollisionShapeCache::TriangleMesh* CollisionShapeCache::AcquireMesh(uint64_t hash, const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount) {
+	auto found = meshes.find(hash);
+	if (found != meshes.end()) {
+		found->second->refCount++;
+		return found->second;
+	}
+
+	// Bullet reads the triangles from these for as long as the mesh lives,
+	// the Shape's own geometry goes away with the Shape
+	TriangleMesh* mesh = new TriangleMesh();
+	mesh->hash = hash;
+	mesh->positions.resize(vertexCount * 3);
+	for (int i = 0; i < vertexCount; i++) {
+		memcpy(&mesh->positions[i * 3], vertices[i].position, sizeof(vertices[i].position));
+	}
+	mesh->indices.assign(indices, indices + indexCount);
+	mesh->bvhBuffer = nullptr;
+	mesh->refCount = 1;
+
+	btIndexedMesh part;
+	part.m_numTriangles = indexCount / 3;
+	part.m_triangleIndexBase = (const unsigned char*)mesh->indices.data();
+	part.m_triangleIndexStride = 3 * sizeof(unsigned short);
+	part.m_numVertices = vertexCount;
+	part.m_vertexBase = (const unsigned char*)mesh->positions.data();
+	part.m_vertexStride = 3 * sizeof(float);
+	part.m_indexType = PHY_SHORT;
+	part.m_vertexType = PHY_FLOAT;
+	mesh->meshInterface = new btTriangleIndexVertexArray();
+	mesh->meshInterface->addIndexedMesh(part, PHY_SHORT);
+
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.bvh", (unsigned long long)hash);
+	std::string path = std::string(BVH_DIRECTORY) + "\\" + fileName;
+	if (!LoadBvh(mesh, path)) {
+		mesh->shape = new btBvhTriangleMeshShape(mesh->meshInterface, true);
+		SaveBvh(mesh, path);
+	}
+
+	meshes[hash] = mesh;
+	return mesh;
+}
+
+void CollisionShapeCache::ReleaseMesh(TriangleMesh* mesh) {
+	mesh->refCount--;
+	if (mesh->refCount == 0) {
+		meshes.erase(mesh->hash);
+		delete mesh->shape;
+		delete mesh->meshInterface;
+		if (mesh->bvhBuffer) {
+			btAlignedFree(mesh->bvhBuffer);
+		}
+		delete mesh;
+	}
+}
+
+bool CollisionShapeCache::LoadBvh(TriangleMesh* mesh, std::string path) {
+	std::ifstream file(path, std::ios::binary);
+	BvhFileHeader header;
+	if (!file
+		|| !file.read((char*)&header, sizeof(header))
+		|| memcmp(header.magic, BVH_MAGIC, sizeof(header.magic)) != 0
+		|| header.scalarSize != sizeof(btScalar)
+		|| header.geometryHash != mesh->hash) {
+		return false;
+	}
+
+	// The tree is used right where it was read, pointers are fixed up in place
+	void* buffer = btAlignedAlloc(header.bvhSize, 16);
+	btOptimizedBvh* bvh = nullptr;
+	if (file.read((char*)buffer, header.bvhSize)) {
+		bvh = (btOptimizedBvh*)btOptimizedBvh::deSerializeInPlace(buffer, header.bvhSize, false);
+	}
+	if (!bvh) {
+		btAlignedFree(buffer);
+		return false;
+	}
+
+	mesh->shape = new btBvhTriangleMeshShape(mesh->meshInterface, true, false);
+	mesh->shape->setOptimizedBvh(bvh);
+	mesh->bvhBuffer = buffer;
+	return true;
+}
+
+void CollisionShapeCache::SaveBvh(TriangleMesh* mesh, std::string path) {
+	btOptimizedBvh* bvh = mesh->shape->getOptimizedBvh();
+	unsigned int size = bvh->calculateSerializeBufferSize();
+	void* buffer = btAlignedAlloc(size, 16);
+
+	// A cache that cannot be written only costs the next run a rebuild
+	if (bvh->serializeInPlace(buffer, size, false)) {
+		CreateDirectoryA(BVH_DIRECTORY, nullptr);
+
+		BvhFileHeader header = {};
+		memcpy(header.magic, BVH_MAGIC, sizeof(header.magic));
+		header.scalarSize = sizeof(btScalar);
+		header.geometryHash = mesh->hash;
+		header.bvhSize = size;
+
+		std::ofstream file(path, std::ios::binary);
+		file.write((char*)&header, sizeof(header));
+		file.write((char*)buffer, size);
+	}
+	btAlignedFree(buffer);
+}
+
+uint64_t CollisionShapeCache::HashGeometry(const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount) {
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](const void* data, size_t size) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+	};
+
+	for (int i = 0; i < vertexCount; i++) {
+		add(vertices[i].position, sizeof(vertices[i].position));
+	}
+	add(indices, indexCount * sizeof(unsigned short));
+	return hash;
+}
+
+int CollisionShapeCache::GetShapeCount() {
+	return shapes.size();
+}
+
+int CollisionShapeCache::GetTriangleMeshCount() {
+	return meshes.size();
+}
@@ -0,0 +1,70 @@
+#ifndef H_COLLISIONSHAPECACHE
+#define H_COLLISIONSHAPECACHE
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "btBulletDynamicsCommon.h"
+
+struct VERTEX;
+
+// Collision shapes shared by every Rigidbody with the same type, geometry and
+// extents, Bullet only reads them, so a thousand equal crates cost one shape.
+// Shapes are refcounted and deleted with their last user. Triangle mesh trees
+// are saved to BVH_DIRECTORY and loaded from there on later runs instead of
+// being built again.
+class CollisionShapeCache {
+public:
+	static CollisionShapeCache* GetInstance();
+
+	CollisionShapeCache(CollisionShapeCache& collisionShapeCache) = delete;
+
+	btCollisionShape* AcquireBox(btVector3 halfExtents);
+	// Meshes are in local space and scaled like their GameObject
+	btCollisionShape* AcquireConvexHull(const VERTEX* vertices, int vertexCount, btVector3 scale);
+	btCollisionShape* AcquireTriangleMesh(const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount, btVector3 scale);
+	void Release(btCollisionShape* shape);
+
+	int GetShapeCount();
+	int GetTriangleMeshCount();
+private:
+	CollisionShapeCache();
+	inline static CollisionShapeCache* instance;
+
+	static constexpr const char* BVH_DIRECTORY = "CollisionCache";
+
+	// One per distinct geometry, shared by every scale of it
+	struct TriangleMesh {
+		uint64_t hash;
+		std::vector<float> positions;
+		std::vector<unsigned short> indices;
+		btTriangleIndexVertexArray* meshInterface;
+		btBvhTriangleMeshShape* shape;
+		void* bvhBuffer;			// The loaded tree lives in here, nullptr if it was built
+		int refCount;
+	};
+
+	// Shape type, geometry hash, then the extents or scale
+	typedef std::tuple<int, uint64_t, btScalar, btScalar, btScalar> ShapeKey;
+
+	struct CachedShape {
+		btCollisionShape* shape;
+		int refCount;
+		TriangleMesh* mesh;
+	};
+
+	std::map<ShapeKey, CachedShape> shapes;
+	std::unordered_map<btCollisionShape*, ShapeKey> keys;
+	std::unordered_map<uint64_t, TriangleMesh*> meshes;
+
+	TriangleMesh* AcquireMesh(uint64_t hash, const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount);
+	void ReleaseMesh(TriangleMesh* mesh);
+	bool LoadBvh(TriangleMesh* mesh, std::string path);
+	void SaveBvh(TriangleMesh* mesh, std::string path);
+
+	// Positions and indices only, texture coordinates do not collide
+	static uint64_t HashGeometry(const VERTEX* vertices, int vertexCount, const unsigned short* indices, int indexCount);
+};
+#endif
@@ -1,6 +1,21 @@
 #include "Component.h"
 #include "GameObject.h"
 
+const char* GetComponentTypeName(ComponentType type) {
+	static const char* names[COMPONENT_TYPE_COUNT] = {
+		"Camera",
+		"Light",
+		"PositionConstraint",
+		"Rigidbody",
+		"Script",
+		"Shape",
+		"Cube",
+		"Wedge",
+		"Pyramid",
+	};
+	return names[type];
+}
+
 Component::Component(GameObject* gameObject)
 	:
 	gameObject(gameObject)
@@ -1,7 +1,34 @@
 #ifndef H_COMPONENT
 #define H_COMPONENT
+#include <cstdint>
+#include "System.h"
+
 class GameObject;
 
+// Every component class declares its TYPE and a MASK made of its own type plus
+// the types of the component classes it derives from. GameObject uses them for
+// constant time lookups, including lookups through a base class such as Shape.
+enum ComponentType {
+	COMPONENT_TYPE_CAMERA,
+	COMPONENT_TYPE_LIGHT,
+	COMPONENT_TYPE_POSITION_CONSTRAINT,
+	COMPONENT_TYPE_RIGIDBODY,
+	COMPONENT_TYPE_SCRIPT,
+	COMPONENT_TYPE_SHAPE,
+	COMPONENT_TYPE_CUBE,
+	COMPONENT_TYPE_WEDGE,
+	COMPONENT_TYPE_PYRAMID,
+	COMPONENT_TYPE_COUNT
+};
+
+typedef uint32_t ComponentMask;
+
+#define COMPONENT_MASK(type) ((ComponentMask)1 << (type))
+
+static_assert(COMPONENT_TYPE_COUNT <= 16, "Component masks must fit below the Access bits");
+
+const char* GetComponentTypeName(ComponentType type);
+
 class Component {
 public:
 	Component(Component& component) = delete;
@@ -9,6 +36,15 @@ public:
 	GameObject* GetGameObject();
 
 	virtual void Update() = 0;
+
+	// What the pool of a component type declares to Game, see System. Only
+	// components that touch nothing but their own object may set PARALLEL_UPDATE,
+	// their Update then runs on any thread, many at once. Components kept up to
+	// date from elsewhere clear UPDATES, their pool is then not a System at all.
+	static const AccessMask READS = ACCESS_ALL;
+	static const AccessMask WRITES = ACCESS_ALL;
+	static const bool PARALLEL_UPDATE = false;
+	static const bool UPDATES = true;
 protected:
 	Component(GameObject* gameObject);
 
@@ -0,0 +1,175 @@
+#ifndef H_COMPONENTPOOL
+#define H_COMPONENTPOOL
+#include <new>
+#include <vector>
+#include "System.h"
+#include "Component.h"
+#include "AllocatorStats.h"
+#include "JobSystem.h"
+
+class GameObject;
+
+// Stores every component of one concrete type in contiguous chunks and updates
+// them in one pass. Chunks never move, so component pointers stay valid.
+template<class T>
+class ComponentPool : public System {
+public:
+	static ComponentPool<T>* GetInstance() {
+		if (!instance) {
+			instance = new ComponentPool<T>();
+			if constexpr (T::UPDATES) {
+				Register(instance);
+			}
+		}
+		return instance;
+	}
+
+	// The slot identifies the component inside the pool and is needed to destroy it
+	T* Create(GameObject* gameObject, int* slot) {
+		if (freeSlots.size() > 0) {
+			*slot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			// Chunks past the active one are empty, made ahead of time by Reserve
+			if (activeChunk < chunks.size() && chunks[activeChunk]->count == CHUNK_SIZE) {
+				activeChunk++;
+			}
+			if (activeChunk == chunks.size()) {
+				AddChunk();
+			}
+			*slot = activeChunk * CHUNK_SIZE + chunks[activeChunk]->count++;
+		}
+
+		Chunk* chunk = chunks[*slot / CHUNK_SIZE];
+		int index = *slot % CHUNK_SIZE;
+
+		T* component = new (chunk->Get(index)) T(gameObject);
+		chunk->alive[index] = true;
+		liveCount++;
+		stats.allocationCount++;
+		stats.liveBytes += sizeof(T);
+		return component;
+	}
+
+	// Makes room for count more components up front, for bulk loads
+	void Reserve(int count) {
+		int capacity = freeSlots.size();
+		for (int i = activeChunk; i < chunks.size(); i++) {
+			capacity += CHUNK_SIZE - chunks[i]->count;
+		}
+		while (capacity < count) {
+			AddChunk();
+			capacity += CHUNK_SIZE;
+		}
+	}
+
+	void Destroy(int slot) {
+		Chunk* chunk = chunks[slot / CHUNK_SIZE];
+		int index = slot % CHUNK_SIZE;
+
+		chunk->Get(index)->~T();
+		chunk->alive[index] = false;
+		freeSlots.push_back(slot);
+		liveCount--;
+		stats.freeCount++;
+		stats.liveBytes -= sizeof(T);
+	}
+
+	static void DestroyComponent(int slot) {
+		GetInstance()->Destroy(slot);
+	}
+
+	void Update() override {
+		if constexpr (T::PARALLEL_UPDATE) {
+			// One chunk per job
+			JobSystem::GetInstance()->ParallelFor(chunks.size(), 1, [this](int begin, int end) {
+				for (int chunk = begin; chunk < end; chunk++) {
+					UpdateChunk(chunks[chunk]);
+				}
+			});
+		}
+		else {
+			for (Chunk* chunk : chunks) {
+				UpdateChunk(chunk);
+			}
+		}
+	}
+
+	int GetUpdateOrder() override {
+		return T::UPDATE_ORDER;
+	}
+
+	AccessMask GetReads() override {
+		return T::READS;
+	}
+
+	AccessMask GetWrites() override {
+		return T::WRITES | COMPONENT_MASK(T::TYPE);
+	}
+
+	bool IsMainThreadOnly() override {
+		return !T::PARALLEL_UPDATE;
+	}
+
+	template<typename F>
+	void ForEach(F function) {
+		for (Chunk* chunk : chunks) {
+			for (int i = 0; i < chunk->count; i++) {
+				if (chunk->alive[i]) {
+					function(chunk->Get(i));
+				}
+			}
+		}
+	}
+
+	int GetCount() {
+		return liveCount;
+	}
+
+	AllocatorStats* GetStats() {
+		return &stats;
+	}
+private:
+	ComponentPool()
+		:
+		stats(GetComponentTypeName(T::TYPE)),
+		liveCount(0),
+		activeChunk(0)
+	{}
+	inline static ComponentPool<T>* instance;
+
+	static const int CHUNK_SIZE = 256;
+
+	struct Chunk {
+		alignas(T) unsigned char storage[CHUNK_SIZE * sizeof(T)];
+		bool alive[CHUNK_SIZE] = {};
+		int count = 0;
+
+		T* Get(int index) {
+			return reinterpret_cast<T*>(storage) + index;
+		}
+	};
+
+	std::vector<Chunk*> chunks;
+	std::vector<int> freeSlots;
+	AllocatorStats stats;
+	int liveCount;
+	int activeChunk;
+
+	void AddChunk() {
+		chunks.push_back(new Chunk());
+		stats.heapAllocationCount++;
+		stats.reservedBytes += sizeof(Chunk);
+	}
+
+	void UpdateChunk(Chunk* chunk) {
+		for (int i = 0; i < chunk->count; i++) {
+			if (chunk->alive[i]) {
+				// Qualified call, no virtual dispatch per component
+				chunk->Get(i)->T::Update();
+			}
+		}
+	}
+};
+#endif
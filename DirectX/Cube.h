@@ -7,6 +7,9 @@
 
 class Cube : public ShapeBase<Cube> {
 public:
+	static const ComponentType TYPE = COMPONENT_TYPE_CUBE;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE) | Shape::MASK;
+
 	Cube(GameObject* gameObject);
 protected:
 	void SetupVertices() override;
@@ -0,0 +1,105 @@
+#ifndef H_DDSFORMAT
+#define H_DDSFORMAT
+#include <cstddef>
+#include <cstdint>
+
+// The subset of DDS written by TextureCooker and read by TextureLoader:
+//   DDS_MAGIC
+//   DdsHeader
+//   DdsHeaderDx10
+//   every mip level in order, largest first, rows of 4x4 blocks
+// Formats are stored as their DXGI_FORMAT values.
+#define DDS_MAGIC "DDS "
+#define DDS_FOURCC_DX10 0x30315844u		// "DX10"
+
+#define DDS_FORMAT_R8G8B8A8_UNORM 28u
+#define DDS_FORMAT_BC1_UNORM 71u
+#define DDS_FORMAT_BC3_UNORM 77u
+#define DDS_FORMAT_BC7_UNORM 98u
+
+#define DDS_FLAGS_TEXTURE 0x000A1007u		// Caps, height, width, pixel format, mip count, linear size
+#define DDS_PIXEL_FLAGS_FOURCC 0x4u
+#define DDS_CAPS_TEXTURE 0x00401008u		// Texture, mipmap, complex
+#define DDS_DIMENSION_TEXTURE2D 3u
+
+struct DdsPixelFormat {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+
+struct DdsHeader {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixelFormat;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DdsHeader must match the file layout");
+static_assert(sizeof(DdsHeaderDx10) == 20, "DdsHeaderDx10 must match the file layout");
+
+// Bytes per 4x4 block, 0 for formats that are not block compressed
+inline int GetDdsBlockSize(uint32_t format) {
+	switch (format) {
+	case DDS_FORMAT_BC1_UNORM:
+		return 8;
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC7_UNORM:
+		return 16;
+	}
+	return 0;
+}
+
+// Bytes of one row of pixels, or of blocks for compressed formats
+inline size_t GetDdsRowPitch(uint32_t format, int width) {
+	int blockSize = GetDdsBlockSize(format);
+	return blockSize ? (size_t)((width + 3) / 4) * blockSize : (size_t)width * 4;
+}
+
+inline size_t GetDdsMipSize(uint32_t format, int width, int height) {
+	int rows = GetDdsBlockSize(format) ? (height + 3) / 4 : height;
+	return GetDdsRowPitch(format, width) * rows;
+}
+
+// The coarsest mip a texture can be created from, compressed textures need
+// their top mip to be whole blocks
+inline int GetDdsCoarsestFirstMip(uint32_t format, int width, int height, int mipCount) {
+	if (!GetDdsBlockSize(format)) {
+		return mipCount - 1;
+	}
+
+	int mip = 0;
+	while (mip < mipCount - 1) {
+		int nextWidth = width >> (mip + 1);
+		int nextHeight = height >> (mip + 1);
+		if (nextWidth < 4 || nextHeight < 4 || nextWidth % 4 != 0 || nextHeight % 4 != 0) {
+			break;
+		}
+		mip++;
+	}
+	return mip;
+}
+#endif
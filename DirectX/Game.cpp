@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <climits>
 #include "Game.h"
 #include "btBulletDynamicsCommon.h"
 #include "Clock.h"
@@ -5,6 +7,8 @@
 #include "imgui_impl_win32.h"
 #include "imgui_impl_dx11.h"
 #include "Gui.h"
+#include "JobSystem.h"
+#include "TextureCache.h"
 
 void Game::Init(HWND hWnd) {
 	instance = new Game(hWnd);
@@ -12,22 +16,88 @@ void Game::Init(HWND hWnd) {
 
 Game::Game(HWND hWnd) 
 	:
-	lastUpdateTime(Clock::GetSingleton().GetTimeSinceStart())
+	lastUpdateTime(Clock::GetSingleton().GetTimeSinceStart()),
+	frameCount(0),
+	mainCamera(nullptr)
 {}
 
 Game* Game::GetInstance() {
 	return instance;
 }
 
-void Game::AddGameObject(GameObject* gameObject) {
+void Game::Reserve(int count) {
+	gameObjects.reserve(gameObjects.size() + count);
+	if (freeSlots.size() < count) {
+		slots.reserve(slots.size() + count - freeSlots.size());
+	}
+}
+
+GameObjectHandle Game::AddGameObject(GameObject* gameObject) {
+	uint32_t index;
+	if (freeSlots.size() > 0) {
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		index = slots.size();
+		slots.push_back({ nullptr, 0, 0 });
+	}
+
+	slots[index].gameObject = gameObject;
+	slots[index].denseIndex = gameObjects.size();
 	gameObjects.push_back(gameObject);
+
+	return { index, slots[index].generation };
+}
+
+GameObject* Game::GetGameObject(GameObjectHandle handle) {
+	if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+		return nullptr;
+	}
+	return slots[handle.index].gameObject;
+}
+
+void Game::DestroyGameObject(GameObjectHandle handle) {
+	GameObject* gameObject = GetGameObject(handle);
+	if (!gameObject) {
+		return;
+	}
+
+	// The object stays alive until the end of the frame, but handles stop resolving now
+	slots[handle.index].generation++;
+	pendingDestroys.push_back({ handle.index, slots[handle.index].generation });
+}
+
+void Game::DestroyPendingGameObjects() {
+	for (GameObjectHandle pending : pendingDestroys) {
+		Slot& slot = slots[pending.index];
+
+		// Swap remove from the dense array
+		GameObject* last = gameObjects.back();
+		gameObjects[slot.denseIndex] = last;
+		slots[last->GetHandle().index].denseIndex = slot.denseIndex;
+		gameObjects.pop_back();
+
+		delete slot.gameObject;
+		slot.gameObject = nullptr;
+		freeSlots.push_back(pending.index);
+	}
+	pendingDestroys.clear();
+}
+
+void Game::AddSystem(System* system) {
+	// Keep the systems sorted, systems with the same order run in registration order
+	auto position = std::upper_bound(systems.begin(), systems.end(), system, [](System* a, System* b) {
+		return a->GetUpdateOrder() < b->GetUpdateOrder();
+	});
+	systems.insert(position, system);
 }
 
 void Game::SetMainCamera(Camera* camera) {
 	mainCamera = camera;
 }
 
-std::vector<GameObject*> Game::GetGameObjects() {
+std::span<GameObject* const> Game::GetGameObjects() {
 	return gameObjects;
 }
 
@@ -39,16 +109,28 @@ float Game::GetLastUpdateTime() {
 	return lastUpdateTime;
 }
 
+int Game::GetFrameCount() {
+	return frameCount;
+}
+
 void Game::Update() {
+	// The first frame has no delta, loading time would otherwise make it differ between runs
+	if (frameCount == 0) {
+		lastUpdateTime = Clock::GetSingleton().GetTimeSinceStart();
+		Physics::GetInstance()->ResetClock();
+	}
+
 	Physics::GetInstance()->Update();
+	UpdateSystems(INT_MIN, UPDATE_ORDER_RENDER);
+
+	// Textures decoded since the last frame replace their placeholders before drawing
+	TextureCache::GetInstance()->Update();
 
 	Graphics::GetInstance()->ClearFrame();
 	Graphics::GetInstance()->BindLightingBuffer();
 	Graphics::GetInstance()->GenerateShadowMap();
 
-	for (GameObject* gameObject : gameObjects) {
-		gameObject->Update();
-	}
+	UpdateRenderSystems();
 	lastUpdateTime = Clock::GetSingleton().GetTimeSinceStart();
 
 	// Start the Dear ImGui frame
@@ -60,4 +142,63 @@ void Game::Update() {
 	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
 	Graphics::GetInstance()->RenderFrame();
+
+	DestroyPendingGameObjects();
+	frameCount++;
+}
+
+void Game::UpdateRenderSystems() {
+	UpdateSystems(UPDATE_ORDER_RENDER, INT_MAX);
+}
+
+void Game::UpdateSystems(int minOrder, int maxOrder) {
+	// Consecutive systems that do not touch each other's data form a batch, a
+	// conflict ends the batch so the update order still holds where it matters
+	std::vector<System*> batch;
+	AccessMask batchReads = 0;
+	AccessMask batchWrites = 0;
+
+	for (System* system : systems) {
+		int order = system->GetUpdateOrder();
+		if (order < minOrder || order >= maxOrder) {
+			continue;
+		}
+
+		AccessMask reads = system->GetReads();
+		AccessMask writes = system->GetWrites();
+		if ((writes & (batchReads | batchWrites)) || (reads & batchWrites)) {
+			UpdateBatch(batch);
+			batch.clear();
+			batchReads = 0;
+			batchWrites = 0;
+		}
+
+		batch.push_back(system);
+		batchReads |= reads;
+		batchWrites |= writes;
+	}
+
+	UpdateBatch(batch);
+}
+
+void Game::UpdateBatch(std::vector<System*>& batch) {
+	if (batch.size() == 1) {
+		batch[0]->Update();
+		return;
+	}
+
+	JobSystem::Graph graph;
+	for (System* system : batch) {
+		if (!system->IsMainThreadOnly()) {
+			graph.Add([system]() { system->Update(); });
+		}
+	}
+	graph.Run();
+
+	for (System* system : batch) {
+		if (system->IsMainThreadOnly()) {
+			system->Update();
+		}
+	}
+	graph.Wait();
 }
@@ -1,10 +1,13 @@
 #include <Windows.h>
 #include <vector>
+#include <span>
 
 #include "Graphics.h"
 #include "Physics.h"
 #include "GameObject.h"
 #include "Camera.h"
+#include "System.h"
+#include "GameObjectHandle.h"
 
 class Game {
 public:
@@ -12,12 +15,19 @@ public:
 	static Game* GetInstance();
 
 	float GetLastUpdateTime();
+	int GetFrameCount();
 
-	void AddGameObject(GameObject* gameObject);
+	// Makes room for count more objects up front, for bulk loads
+	void Reserve(int count);
+	GameObjectHandle AddGameObject(GameObject* gameObject);
+	GameObject* GetGameObject(GameObjectHandle handle);
+	void DestroyGameObject(GameObjectHandle handle);
+	void AddSystem(System* system);
 	void Update();
+	void UpdateRenderSystems();
 	void SetMainCamera(Camera* camera);
 
-	std::vector<GameObject*> GetGameObjects();
+	std::span<GameObject* const> GetGameObjects();
 	Camera* GetMainCamera();
 
 	Game(Game& game) = delete;
@@ -25,7 +35,23 @@ private:
 	Game(HWND hWnd);
 	inline static Game* instance;
 
+	struct Slot {
+		GameObject* gameObject;
+		uint32_t generation;
+		uint32_t denseIndex;
+	};
+
+	// Live objects are kept dense for iteration, slots map handles onto them
 	std::vector<GameObject*> gameObjects;
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+	std::vector<GameObjectHandle> pendingDestroys;
+	std::vector<System*> systems;
 	float lastUpdateTime;
+	int frameCount;
 	Camera* mainCamera;
+
+	void UpdateSystems(int minOrder, int maxOrder);
+	void UpdateBatch(std::vector<System*>& batch);
+	void DestroyPendingGameObjects();
 };
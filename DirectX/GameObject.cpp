@@ -4,37 +4,98 @@
 #include "Component.h"
 #include "Rigidbody.h"
 #include "Script.h"
+#include "SlabAllocator.h"
+#include "TransformHierarchy.h"
+
+static SlabAllocator<GameObject>& GetAllocator() {
+	static SlabAllocator<GameObject> allocator("GameObject");
+	return allocator;
+}
+
+void* GameObject::operator new(size_t size) {
+	return GetAllocator().Allocate();
+}
+
+void GameObject::operator delete(void* pointer) {
+	GetAllocator().Free(pointer);
+}
+
+AllocatorStats* GameObject::GetAllocatorStats() {
+	return GetAllocator().GetStats();
+}
 
 GameObject::GameObject()
 	:
-	transform(btTransform()),
-	scale(btVector3(1, 1, 1))
+	componentMask(0),
+	componentSlots()
 {
-	Game::GetInstance()->AddGameObject(this);
+	handle = Game::GetInstance()->AddGameObject(this);
+	transformNode = TransformHierarchy::GetInstance()->CreateNode(this, btTransform::getIdentity(), btVector3(1, 1, 1));
 }
 
 GameObject::GameObject(btTransform transform, btVector3 scale) 
 	:
-	transform(transform),
-	scale(scale)
+	componentMask(0),
+	componentSlots()
 {
-	Game::GetInstance()->AddGameObject(this);
+	handle = Game::GetInstance()->AddGameObject(this);
+	transformNode = TransformHierarchy::GetInstance()->CreateNode(this, transform, scale);
+}
+
+GameObject::~GameObject() {
+	// Destroy in reverse so components can still reach the ones they were added after
+	for (int i = ownedComponents.size() - 1; i >= 0; i--) {
+		ownedComponents[i].destroy(ownedComponents[i].slot);
+	}
+
+	TransformHierarchy::GetInstance()->DestroyNode(transformNode);
+}
+
+GameObjectHandle GameObject::GetHandle() {
+	return handle;
 }
 
 btVector3 GameObject::GetScale() {
-	return scale;
+	return TransformHierarchy::GetInstance()->GetScale(transformNode);
+}
+
+GameObject* GameObject::GetParent() {
+	int parentNode = TransformHierarchy::GetInstance()->GetParent(transformNode);
+	return parentNode < 0 ? nullptr : TransformHierarchy::GetInstance()->GetOwner(parentNode);
 }
 
 btTransform GameObject::GetTransform() {
-	return transform;
+	return TransformHierarchy::GetInstance()->GetWorld(transformNode);
+}
+
+btTransform GameObject::GetLocalTransform() {
+	return TransformHierarchy::GetInstance()->GetLocal(transformNode);
+}
+
+const dx::XMMATRIX& GameObject::GetWorldMatrix() {
+	return TransformHierarchy::GetInstance()->GetWorldMatrix(transformNode);
+}
+
+const dx::BoundingBox& GameObject::GetWorldBounds() {
+	return TransformHierarchy::GetInstance()->GetWorldBounds(transformNode);
+}
+
+bool GameObject::IsVisible(bool shadowPass) {
+	return TransformHierarchy::GetInstance()->IsVisible(transformNode, shadowPass);
 }
 
 void GameObject::SetTransform(btTransform transform) {
-	this->transform = transform;
+	TransformHierarchy::GetInstance()->SetWorld(transformNode, transform);
 }
 
-void GameObject::Update() {
-	for (Component* component : components) {
-		component->Update();
-	}
+void GameObject::SetLocalTransform(btTransform transform) {
+	TransformHierarchy::GetInstance()->SetLocal(transformNode, transform);
+}
+
+void GameObject::SetScale(btVector3 scale) {
+	TransformHierarchy::GetInstance()->SetScale(transformNode, scale);
+}
+
+void GameObject::SetParent(GameObject* parent, bool inheritRotation) {
+	TransformHierarchy::GetInstance()->SetParent(transformNode, parent ? parent->transformNode : -1, inheritRotation);
 }
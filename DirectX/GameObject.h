@@ -3,45 +3,79 @@
 #include <vector>
 #include <type_traits>
 #include "Shape.h"
+#include "Component.h"
+#include "ComponentPool.h"
+#include "GameObjectHandle.h"
+#include "AllocatorStats.h"
 #include "btBulletDynamicsCommon.h"
-
-class Component;
-class Script;
+#include "Main.h"
+#include <DirectXCollision.h>
 
 class GameObject {
 public:
 	GameObject();
 	GameObject(btTransform transform, btVector3 scale);
 
+	// GameObjects live in a slab allocator instead of the global heap
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
+	static AllocatorStats* GetAllocatorStats();
+
+	GameObjectHandle GetHandle();
+	GameObject* GetParent();
 	btVector3 GetScale();
 	btTransform GetTransform();
+	btTransform GetLocalTransform();
+	const dx::XMMATRIX& GetWorldMatrix();
+	const dx::BoundingBox& GetWorldBounds();
+	bool IsVisible(bool shadowPass);
 
 	void SetTransform(btTransform transform);
-	void Update();
+	void SetLocalTransform(btTransform transform);
+	void SetScale(btVector3 scale);
+	void SetParent(GameObject* parent, bool inheritRotation = true);
 
 	template<typename T, typename std::enable_if<std::is_base_of<Component, T>::value>::type* = nullptr>
 	T* GetComponent() {
-		for (Component* component : components) {			
-			if (dynamic_cast<T*>(component)) {
-				return static_cast<T*>(component);
-			}
-		}
-		return NULL;
+		return static_cast<T*>(componentSlots[T::TYPE]);
+	}
+
+	template<typename T, typename std::enable_if<std::is_base_of<Component, T>::value>::type* = nullptr>
+	bool HasComponent() {
+		return (componentMask & COMPONENT_MASK(T::TYPE)) != 0;
 	}
 
 	template<typename T, typename std::enable_if<std::is_base_of<Component, T>::value>::type* = nullptr>
 	void AddComponent() {
-		T* t = new T(this);
-		components.push_back(t);
+		static_assert((T::MASK & COMPONENT_MASK(T::TYPE)) != 0, "Component MASK must contain its own TYPE");
+
+		int slot;
+		T* t = ComponentPool<T>::GetInstance()->Create(this, &slot);
+		ownedComponents.push_back({ slot, &ComponentPool<T>::DestroyComponent });
 
-		if (std::is_same<T, Script>::value) {
-			inputControllers.push_back((Script*)(t));
+		// Fill the slot of the type and of all its bases, the first component added wins
+		for (int type = 0; type < COMPONENT_TYPE_COUNT; type++) {
+			if ((T::MASK & COMPONENT_MASK(type)) && !componentSlots[type]) {
+				componentSlots[type] = t;
+			}
 		}
+		componentMask |= T::MASK;
 	}
 private:
-	btTransform transform;
-	btVector3 scale;
-	std::vector<Component*> components;
-	std::vector<Script*> inputControllers;
+	friend class Game;
+
+	// Only Game destroys objects, at the end of the frame they were destroyed in
+	~GameObject();
+
+	struct OwnedComponent {
+		int slot;
+		void (*destroy)(int slot);
+	};
+
+	GameObjectHandle handle;
+	int transformNode;
+	ComponentMask componentMask;
+	Component* componentSlots[COMPONENT_TYPE_COUNT];
+	std::vector<OwnedComponent> ownedComponents;
 };
 #endif
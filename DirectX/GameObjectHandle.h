@@ -0,0 +1,19 @@
+#ifndef H_GAMEOBJECTHANDLE
+#define H_GAMEOBJECTHANDLE
+#include <cstdint>
+
+// Safe reference to a GameObject. The generation is bumped every time the slot
+// is reused, so a handle to a destroyed object never resolves to its successor.
+struct GameObjectHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const GameObjectHandle& other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const GameObjectHandle& other) const {
+		return !(*this == other);
+	}
+};
+#endif
@@ -1,4 +1,5 @@
 #include <vector>
+#include <algorithm>
 #include "Graphics.h"
 #include "Mouse.h"
 #include "Game.h"
@@ -6,8 +7,6 @@
 #include "Gui.h"
 #include "Light.h"
 
-#define MAX_LIGHT_COUNT 12
-
 using namespace std;
 
 void Graphics::Init(HWND hWnd, float nearZ, float farZ) {
@@ -22,7 +21,8 @@ Graphics::Graphics(HWND hWnd, float nearZ, float farZ)
     :
     hWnd(hWnd),
     nearZ(nearZ),
-    farZ(farZ)
+    farZ(farZ),
+    renderingShadowMap(false)
 {
     InitD3D();
     InitPipeline();
@@ -282,9 +282,25 @@ void Graphics::BindLightingBuffer() {
 }
 
 void Graphics::AddLight(Light* light) {
+    if (lightDataVector.size() >= MAX_LIGHT_COUNT) {
+        Main::HandleError(0, __FILE__, __LINE__, "Tried to add more lights than the lighting buffer holds");
+    }
+
     lightDataVector.push_back(&light->lightData);
 }
 
+void Graphics::RemoveLight(Light* light) {
+    lightDataVector.erase(std::remove(lightDataVector.begin(), lightDataVector.end(), &light->lightData), lightDataVector.end());
+}
+
+int Graphics::GetLightCount() {
+    return lightDataVector.size();
+}
+
+bool Graphics::IsRenderingShadowMap() {
+    return renderingShadowMap;
+}
+
 void Graphics::InitShadowMapResources() {
     RECT clientRect;
     GetClientRect(hWnd, &clientRect);
@@ -356,12 +372,9 @@ void Graphics::GenerateShadowMap() {
     pContext->OMSetRenderTargets(0u, 0, pShadowMapDepthView);
 
     // Render the scene
-    for (GameObject* gameObject : Game::GetInstance()->GetGameObjects()) {
-        Shape* shape = gameObject->GetComponent<Shape>();
-        if (shape) {
-            shape->Update();
-        }
-    }
+    renderingShadowMap = true;
+    Game::GetInstance()->UpdateRenderSystems();
+    renderingShadowMap = false;
 
     // Clear renderTargetView
     ClearFrame();
@@ -11,6 +11,8 @@
 #define SHADER_FILE_NAME_TEXTURE L"TextureShaders.hlsl"
 #define SHADER_FILE_NAME_SHADOW_MAP L"ShadowMapShaders.hlsl"
 
+#define MAX_LIGHT_COUNT 12
+
 class Gui;
 
 struct VERTEX {
@@ -32,6 +34,8 @@ public:
     ID3D11DeviceContext* GetDeviceContext();
     float GetNearZ();
     float GetFarZ();
+    int GetLightCount();
+    bool IsRenderingShadowMap();
 
     void ClearFrame();
     void RenderFrame();
@@ -40,6 +44,7 @@ public:
     void SetFarZ(float farZ);
     void BindLightingBuffer();
     void AddLight(Light* light);
+    void RemoveLight(Light* light);
     void GenerateShadowMap();
 private:
     Graphics(HWND hWnd, float nearZ, float farZ);
@@ -64,6 +69,7 @@ private:
     ID3D11DepthStencilView* pShadowMapDepthView;
     ID3D11ShaderResourceView* pShadowMapSRView;
     ID3D11SamplerState* pShadowMapSamplerState;
+    bool renderingShadowMap;
 
     void InitD3D();
     void InitPipeline();
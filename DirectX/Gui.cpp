@@ -5,6 +5,10 @@
 #include "Graphics.h"
 #include "Clock.h"
 #include "Game.h"
+#include "AllocatorStats.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "CollisionShapeCache.h"
 
 void Gui::Init(HWND hWnd) {
     instance = new Gui(hWnd);
@@ -61,6 +65,34 @@ void Gui::Update() {
         ImGui::End();
     }
 
+    // 3. Allocator statistics
+    {
+        ImGui::Begin("Memory");
+
+        if (ImGui::TreeNode("Textures")) {
+            TextureCache* cache = TextureCache::GetInstance();
+            ImGui::Text("Files: %d (%d unused)", cache->GetEntryCount(), cache->GetReleasedCount());
+            ImGui::Text("Loading: %d (%d streaming mips)", TextureLoader::GetInstance()->GetPendingCount(), cache->GetStreamingCount());
+            ImGui::Text("CPU: %.1f MB of %.1f MB", cache->GetResidentCpuBytes() / 1048576.0f, cache->GetCpuBudget() / 1048576.0f);
+            ImGui::Text("GPU: %.1f MB of %.1f MB", cache->GetResidentGpuBytes() / 1048576.0f, cache->GetGpuBudget() / 1048576.0f);
+            ImGui::TreePop();
+        }
+
+        ImGui::Text("Collision shapes: %d (%d triangle meshes)", CollisionShapeCache::GetInstance()->GetShapeCount(), CollisionShapeCache::GetInstance()->GetTriangleMeshCount());
+
+        for (AllocatorStats* stats : AllocatorStats::GetAll()) {
+            if (ImGui::TreeNode(stats->name)) {
+                ImGui::Text("Allocations: %zu (%zu freed)", stats->allocationCount, stats->freeCount);
+                ImGui::Text("Heap allocations: %zu", stats->heapAllocationCount);
+                ImGui::Text("Live: %.1f KB of %.1f KB", stats->liveBytes / 1024.0f, stats->reservedBytes / 1024.0f);
+                ImGui::Text("Fragmentation: %.1f%%", stats->GetFragmentation() * 100.0f);
+                ImGui::TreePop();
+            }
+        }
+
+        ImGui::End();
+    }
+
     if (nearZ != Graphics::GetInstance()->GetNearZ()) {
         Graphics::GetInstance()->SetNearZ(nearZ);
     }
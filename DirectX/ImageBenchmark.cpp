@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "ImageBenchmark.h"
+#include "ImageProcessing.h"
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "stb_image_resize.h"
+
+namespace {
+	const int RUN_COUNT = 5;
+
+	double Time(std::function<void()> work) {
+		double best = 1e30;
+		for (int i = 0; i < RUN_COUNT; i++) {
+			auto start = std::chrono::high_resolution_clock::now();
+			work();
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+		return best;
+	}
+
+	void StbResize(const unsigned char* source, int size, unsigned char* target, int targetSize, stbir_filter filter, stbir_colorspace space) {
+		stbir_resize_uint8_generic(
+			source, size, size, 0,
+			target, targetSize, targetSize, 0,
+			4, STBIR_ALPHA_CHANNEL_NONE, 0, STBIR_EDGE_CLAMP, filter, space, NULL
+		);
+	}
+
+	std::string Line(const char* name, double ours, const char* reference, double theirs) {
+		char line[160];
+		snprintf(line, sizeof(line), "%-22s %8.2f ms   %-24s %8.2f ms   %5.2fx\n", name, ours, reference, theirs, theirs / ours);
+		return line;
+	}
+}
+
+std::string ImageBenchmark::Run(int size) {
+	// Smooth gradients with some noise, like a photo
+	std::vector<unsigned char> source((size_t)size * size * 4);
+	uint32_t noise = 12345;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			noise = noise * 1664525u + 1013904223u;
+			unsigned char* pixel = &source[((size_t)y * size + x) * 4];
+			pixel[0] = (unsigned char)(x * 255 / size);
+			pixel[1] = (unsigned char)(y * 255 / size);
+			pixel[2] = (unsigned char)((noise >> 24) & 63);
+			pixel[3] = 255;
+		}
+	}
+
+	int half = std::max(size / 2, 1);
+	std::vector<unsigned char> target((size_t)size * size * 4);
+	std::vector<unsigned char> rgb((size_t)size * size * 3);
+	for (size_t i = 0; i < (size_t)size * size; i++) {
+		memcpy(&rgb[i * 3], &source[i * 4], 3);
+	}
+
+	std::string report = std::to_string(size) + "x" + std::to_string(size) + " RGBA, AVX2 " + (ImageProcessing::HasAvx2() ? "on" : "off") + "\n";
+
+	report += Line(
+		"Box to half",
+		Time([&]() { ImageProcessing::Resize(source.data(), size, size, target.data(), half, half, ImageProcessing::Filter::Box); }),
+		"stbir box",
+		Time([&]() { StbResize(source.data(), size, target.data(), half, STBIR_FILTER_BOX, STBIR_COLORSPACE_LINEAR); })
+	);
+	report += Line(
+		"Bilinear to half",
+		Time([&]() { ImageProcessing::Resize(source.data(), size, size, target.data(), half, half, ImageProcessing::Filter::Bilinear); }),
+		"stbir triangle",
+		Time([&]() { StbResize(source.data(), size, target.data(), half, STBIR_FILTER_TRIANGLE, STBIR_COLORSPACE_LINEAR); })
+	);
+	// stb has no Lanczos, Catmull-Rom is its closest sharp filter
+	report += Line(
+		"Lanczos to half",
+		Time([&]() { ImageProcessing::Resize(source.data(), size, size, target.data(), half, half, ImageProcessing::Filter::Lanczos); }),
+		"stbir catmull-rom",
+		Time([&]() { StbResize(source.data(), size, target.data(), half, STBIR_FILTER_CATMULLROM, STBIR_COLORSPACE_LINEAR); })
+	);
+	report += Line(
+		"sRGB mip",
+		Time([&]() { ImageProcessing::DownsampleSrgb(source.data(), size, size, target.data()); }),
+		"stbir box sRGB",
+		Time([&]() { StbResize(source.data(), size, target.data(), half, STBIR_FILTER_BOX, STBIR_COLORSPACE_SRGB); })
+	);
+
+	int bgra[4] = { 2, 1, 0, 3 };
+	report += Line(
+		"Swizzle to BGRA",
+		Time([&]() { ImageProcessing::Swizzle(source.data(), size * size, bgra); }),
+		"loop",
+		Time([&]() {
+			for (size_t i = 0; i < (size_t)size * size; i++) {
+				std::swap(source[i * 4], source[i * 4 + 2]);
+			}
+		})
+	);
+	report += Line(
+		"RGB to RGBA",
+		Time([&]() { ImageProcessing::ExpandToRgba(rgb.data(), 3, size * size, target.data()); }),
+		"loop",
+		Time([&]() {
+			for (size_t i = 0; i < (size_t)size * size; i++) {
+				memcpy(&target[i * 4], &rgb[i * 3], 3);
+				target[i * 4 + 3] = 255;
+			}
+		})
+	);
+
+	return report;
+}
@@ -0,0 +1,12 @@
+#ifndef H_IMAGEBENCHMARK
+#define H_IMAGEBENCHMARK
+#include <string>
+
+// Times the ImageProcessing kernels against stb_image_resize and plain loops
+// on a size x size image, "-bench-image 4096" from the command line.
+class ImageBenchmark {
+public:
+	// One line per kernel, best of a few runs in milliseconds
+	static std::string Run(int size);
+};
+#endif
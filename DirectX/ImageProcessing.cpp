@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <intrin.h>
+#include "ImageProcessing.h"
+
+namespace {
+	const float PI = 3.14159265358979f;
+
+	// Source pixels and weights of every target pixel along one axis. Taps past
+	// the edge are clamped to the edge pixel.
+	struct Contributions {
+		int tapCount;
+		std::vector<int> indices;
+		std::vector<float> weights;
+	};
+
+	float GetFilterRadius(ImageProcessing::Filter filter) {
+		switch (filter) {
+		case ImageProcessing::Filter::Box:
+			return 0.5f;
+		case ImageProcessing::Filter::Bilinear:
+			return 1.0f;
+		}
+		return 3.0f;
+	}
+
+	float EvaluateFilter(ImageProcessing::Filter filter, float x) {
+		switch (filter) {
+		case ImageProcessing::Filter::Box:
+			return x >= -0.5f && x < 0.5f ? 1.0f : 0.0f;
+		case ImageProcessing::Filter::Bilinear:
+			return std::max(1.0f - std::abs(x), 0.0f);
+		}
+
+		if (x == 0) {
+			return 1.0f;
+		}
+		if (std::abs(x) >= 3.0f) {
+			return 0.0f;
+		}
+		float px = PI * x;
+		return 3.0f * std::sin(px) * std::sin(px / 3.0f) / (px * px);
+	}
+
+	Contributions GetContributions(int sourceSize, int targetSize, ImageProcessing::Filter filter) {
+		float scale = (float)sourceSize / targetSize;
+		float stretch = std::max(scale, 1.0f);
+		float radius = GetFilterRadius(filter) * stretch;
+
+		Contributions contributions;
+		contributions.tapCount = (int)std::ceil(radius * 2) + 1;
+		contributions.indices.resize((size_t)targetSize * contributions.tapCount);
+		contributions.weights.resize((size_t)targetSize * contributions.tapCount);
+
+		for (int i = 0; i < targetSize; i++) {
+			// Pixel j covers [j, j + 1) in source coordinates
+			float center = (i + 0.5f) * scale;
+			int first = (int)std::floor(center - radius);
+			int* indices = &contributions.indices[(size_t)i * contributions.tapCount];
+			float* weights = &contributions.weights[(size_t)i * contributions.tapCount];
+
+			float total = 0;
+			for (int t = 0; t < contributions.tapCount; t++) {
+				int j = first + t;
+				indices[t] = std::clamp(j, 0, sourceSize - 1);
+				weights[t] = EvaluateFilter(filter, (j + 0.5f - center) / stretch);
+				total += weights[t];
+			}
+			for (int t = 0; total != 0 && t < contributions.tapCount; t++) {
+				weights[t] /= total;
+			}
+		}
+
+		return contributions;
+	}
+
+	__m128 LoadPixel(const unsigned char* pixel) {
+		int bits;
+		memcpy(&bits, pixel, 4);
+		__m128i zero = _mm_setzero_si128();
+		__m128i bytes = _mm_cvtsi32_si128(bits);
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+	}
+
+	// row = sum of weights[t] * source rows indices[t], for length floats
+	void BlendRowsSse(const unsigned char* source, size_t rowPitch, const int* indices, const float* weights, int tapCount, int begin, int length, float* row) {
+		__m128i zero = _mm_setzero_si128();
+		for (int i = begin; i < length; i += 4) {
+			__m128 sum = _mm_setzero_ps();
+			for (int t = 0; t < tapCount; t++) {
+				int bits;
+				memcpy(&bits, source + indices[t] * rowPitch + i, 4);
+				__m128i bytes = _mm_cvtsi32_si128(bits);
+				__m128 values = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+				sum = _mm_add_ps(sum, _mm_mul_ps(values, _mm_set1_ps(weights[t])));
+			}
+			_mm_storeu_ps(row + i, sum);
+		}
+	}
+
+	int BlendRowsAvx2(const unsigned char* source, size_t rowPitch, const int* indices, const float* weights, int tapCount, int length, float* row) {
+		int i = 0;
+		for (; i + 8 <= length; i += 8) {
+			__m256 sum = _mm256_setzero_ps();
+			for (int t = 0; t < tapCount; t++) {
+				__m128i bytes = _mm_loadl_epi64((const __m128i*)(source + indices[t] * rowPitch + i));
+				__m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(values, _mm256_set1_ps(weights[t])));
+			}
+			_mm256_storeu_ps(row + i, sum);
+		}
+		return i;
+	}
+
+	// Filters one row of floats horizontally and rounds it to bytes
+	void ResampleRow(const float* row, const Contributions& contributions, int targetWidth, unsigned char* target) {
+		for (int x = 0; x < targetWidth; x++) {
+			const int* indices = &contributions.indices[(size_t)x * contributions.tapCount];
+			const float* weights = &contributions.weights[(size_t)x * contributions.tapCount];
+
+			__m128 sum = _mm_setzero_ps();
+			for (int t = 0; t < contributions.tapCount; t++) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + indices[t] * 4), _mm_set1_ps(weights[t])));
+			}
+
+			// Lanczos overshoots, the saturating packs clamp it back to 0-255
+			__m128i words = _mm_packs_epi32(_mm_cvtps_epi32(sum), _mm_setzero_si128());
+			int bits = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+			memcpy(target + x * 4, &bits, 4);
+		}
+	}
+
+	struct SrgbTables {
+		float toLinear[256];
+		// Indexed by linear * 4096
+		unsigned char fromLinear[4097];
+
+		SrgbTables() {
+			for (int i = 0; i < 256; i++) {
+				float value = i / 255.0f;
+				toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i <= 4096; i++) {
+				float value = i / 4096.0f;
+				float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1 / 2.4f) - 0.055f;
+				fromLinear[i] = (unsigned char)std::clamp((int)(srgb * 255.0f + 0.5f), 0, 255);
+			}
+		}
+	};
+
+	const SrgbTables& GetSrgbTables() {
+		static SrgbTables tables;
+		return tables;
+	}
+}
+
+void ImageProcessing::Resize(
+	const unsigned char* source, int sourceWidth, int sourceHeight,
+	unsigned char* target, int targetWidth, int targetHeight,
+	Filter filter
+) {
+	Contributions horizontal = GetContributions(sourceWidth, targetWidth, filter);
+	Contributions vertical = GetContributions(sourceHeight, targetHeight, filter);
+
+	// Vertical first, one target row at a time, so only a single row of floats is kept
+	size_t rowPitch = (size_t)sourceWidth * 4;
+	int rowLength = sourceWidth * 4;
+	std::vector<float> row(rowLength);
+	bool avx2 = HasAvx2();
+
+	for (int y = 0; y < targetHeight; y++) {
+		const int* indices = &vertical.indices[(size_t)y * vertical.tapCount];
+		const float* weights = &vertical.weights[(size_t)y * vertical.tapCount];
+
+		int done = avx2 ? BlendRowsAvx2(source, rowPitch, indices, weights, vertical.tapCount, rowLength, row.data()) : 0;
+		BlendRowsSse(source, rowPitch, indices, weights, vertical.tapCount, done, rowLength, row.data());
+
+		ResampleRow(row.data(), horizontal, targetWidth, target + (size_t)y * targetWidth * 4);
+	}
+}
+
+void ImageProcessing::DownsampleSrgb(const unsigned char* source, int width, int height, unsigned char* target) {
+	const SrgbTables& tables = GetSrgbTables();
+	int targetWidth = std::max(width / 2, 1);
+	int targetHeight = std::max(height / 2, 1);
+
+	// Averages four pixels, colors scaled to the table index and alpha back to bytes
+	__m128 scale = _mm_setr_ps(4096 * 0.25f, 4096 * 0.25f, 4096 * 0.25f, 255 * 0.25f);
+
+	for (int y = 0; y < targetHeight; y++) {
+		// Odd edges reuse their last row or column
+		const unsigned char* row0 = source + (size_t)std::min(2 * y, height - 1) * width * 4;
+		const unsigned char* row1 = source + (size_t)std::min(2 * y + 1, height - 1) * width * 4;
+		for (int x = 0; x < targetWidth; x++) {
+			const unsigned char* pixels[4] = {
+				row0 + std::min(2 * x, width - 1) * 4,
+				row0 + std::min(2 * x + 1, width - 1) * 4,
+				row1 + std::min(2 * x, width - 1) * 4,
+				row1 + std::min(2 * x + 1, width - 1) * 4,
+			};
+
+			__m128 sum = _mm_setzero_ps();
+			for (const unsigned char* pixel : pixels) {
+				sum = _mm_add_ps(sum, _mm_setr_ps(
+					tables.toLinear[pixel[0]],
+					tables.toLinear[pixel[1]],
+					tables.toLinear[pixel[2]],
+					pixel[3] / 255.0f
+				));
+			}
+
+			alignas(16) int values[4];
+			_mm_store_si128((__m128i*)values, _mm_cvtps_epi32(_mm_mul_ps(sum, scale)));
+
+			unsigned char* out = target + ((size_t)y * targetWidth + x) * 4;
+			out[0] = tables.fromLinear[values[0]];
+			out[1] = tables.fromLinear[values[1]];
+			out[2] = tables.fromLinear[values[2]];
+			out[3] = (unsigned char)values[3];
+		}
+	}
+}
+
+void ImageProcessing::Swizzle(unsigned char* pixels, int pixelCount, const int* order) {
+	int i = 0;
+	if (HasAvx2()) {
+		// The same byte order for every pixel of both 128 bit lanes
+		alignas(32) char mask[32];
+		for (int b = 0; b < 32; b++) {
+			mask[b] = (char)((b & ~3) + order[b & 3]);
+		}
+		__m256i shuffle = _mm256_load_si256((const __m256i*)mask);
+		for (; i + 8 <= pixelCount; i += 8) {
+			__m256i values = _mm256_loadu_si256((const __m256i*)(pixels + i * 4));
+			_mm256_storeu_si256((__m256i*)(pixels + i * 4), _mm256_shuffle_epi8(values, shuffle));
+		}
+	}
+
+	for (; i < pixelCount; i++) {
+		unsigned char pixel[4];
+		memcpy(pixel, pixels + i * 4, 4);
+		for (int c = 0; c < 4; c++) {
+			pixels[i * 4 + c] = pixel[order[c]];
+		}
+	}
+}
+
+void ImageProcessing::ExpandToRgba(const unsigned char* source, int channelCount, int pixelCount, unsigned char* target) {
+	if (channelCount == 4) {
+		memcpy(target, source, (size_t)pixelCount * 4);
+		return;
+	}
+
+	// Source byte of every target byte for four pixels, -1 writes 0 and gets alpha ORed in
+	static const char MASKS[3][16] = {
+		{ 0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1 },
+		{ 0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7 },
+		{ 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 },
+	};
+
+	int i = 0;
+	if (HasAvx2()) {
+		__m128i shuffle = _mm_loadu_si128((const __m128i*)MASKS[channelCount - 1]);
+		__m128i alpha = channelCount == 2 ? _mm_setzero_si128() : _mm_set1_epi32((int)0xFF000000);
+
+		// Each load reads 16 bytes but only uses four pixels of them
+		int pixelsPerLoad = (16 + channelCount - 1) / channelCount;
+		for (; i + pixelsPerLoad <= pixelCount; i += 4) {
+			__m128i values = _mm_loadu_si128((const __m128i*)(source + i * channelCount));
+			_mm_storeu_si128((__m128i*)(target + i * 4), _mm_or_si128(_mm_shuffle_epi8(values, shuffle), alpha));
+		}
+	}
+
+	for (; i < pixelCount; i++) {
+		const unsigned char* in = source + i * channelCount;
+		unsigned char* out = target + i * 4;
+		if (channelCount < 3) {
+			out[0] = out[1] = out[2] = in[0];
+			out[3] = channelCount == 2 ? in[1] : 255;
+		}
+		else {
+			out[0] = in[0];
+			out[1] = in[1];
+			out[2] = in[2];
+			out[3] = 255;
+		}
+	}
+}
+
+bool ImageProcessing::HasAvx2() {
+	static bool hasAvx2 = []() {
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// The OS has to save the wide registers too, not only the CPU support them
+		__cpuid(info, 1);
+		bool avxEnabled = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+
+		__cpuidex(info, 7, 0);
+		return avxEnabled && (info[1] & (1 << 5)) != 0;
+	}();
+	return hasAvx2;
+}
@@ -0,0 +1,38 @@
+#ifndef H_IMAGEPROCESSING
+#define H_IMAGEPROCESSING
+
+// Pixel kernels for textures, all on tightly packed 8 bit RGBA unless stated
+// otherwise. The resampling kernels run on SSE2 and switch to AVX2 when the
+// CPU has it. Swizzle and ExpandToRgba need byte shuffles, they fall back to
+// plain loops without AVX2. Everything is single threaded, callers already
+// run these off the main thread.
+class ImageProcessing {
+public:
+	enum class Filter {
+		Box,
+		Bilinear,
+		Lanczos,		// 3 lobes, sharpest, may ring on hard edges
+	};
+
+	// Separable resample to any size, shrinking widens the filter so every
+	// source pixel contributes
+	static void Resize(
+		const unsigned char* source, int sourceWidth, int sourceHeight,
+		unsigned char* target, int targetWidth, int targetHeight,
+		Filter filter
+	);
+
+	// The next mip level, half size rounded down. Colors are averaged in
+	// linear light so mips do not darken, alpha is averaged as is.
+	static void DownsampleSrgb(const unsigned char* source, int width, int height, unsigned char* target);
+
+	// Output channel c of every pixel is taken from input channel order[c],
+	// e.g. { 2, 1, 0, 3 } turns RGBA into BGRA
+	static void Swizzle(unsigned char* pixels, int pixelCount, const int* order);
+
+	// Grey, grey and alpha, or RGB pixels to RGBA, missing alpha is opaque
+	static void ExpandToRgba(const unsigned char* source, int channelCount, int pixelCount, unsigned char* target);
+
+	static bool HasAvx2();
+};
+#endif
@@ -0,0 +1,154 @@
+#include "InputActions.h"
+#include "Main.h"
+
+InputActions* InputActions::GetInstance() {
+	if (!instance) {
+		instance = new InputActions();
+		Register(instance);
+	}
+	return instance;
+}
+
+InputActions::InputActions()
+	:
+	nextSubscriptionId(0),
+	dispatching(false),
+	hasUnsubscribed(false)
+{}
+
+int InputActions::GetUpdateOrder() {
+	return UPDATE_ORDER;
+}
+
+ActionId InputActions::AddAction(std::string name) {
+	ActionId existing = GetAction(name);
+	if (existing >= 0) {
+		return existing;
+	}
+
+	// Update holds on to the subscriber lists while it calls them
+	if (dispatching) {
+		Main::HandleError(0, __FILE__, __LINE__, "Tried to add an action from an action callback");
+	}
+
+	actions.push_back({ name, {}, false, {} });
+	return actions.size() - 1;
+}
+
+ActionId InputActions::GetAction(std::string name) {
+	for (int i = 0; i < actions.size(); i++) {
+		if (actions[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+const std::string& InputActions::GetActionName(ActionId action) {
+	return actions[action].name;
+}
+
+void InputActions::Bind(ActionId action, WPARAM key) {
+	if (key >= Keyboard::KEY_COUNT) {
+		Main::HandleError(0, __FILE__, __LINE__, "Tried to bind an action to a key outside of the keyboard");
+	}
+	actions[action].keys.set(key);
+}
+
+void InputActions::Unbind(ActionId action, WPARAM key) {
+	if (key < Keyboard::KEY_COUNT) {
+		actions[action].keys.reset(key);
+	}
+}
+
+bool InputActions::IsDown(ActionId action) {
+	return (Keyboard::GetInstance()->GetDownKeys() & actions[action].keys).any();
+}
+
+bool InputActions::WasPressed(ActionId action) {
+	return (Keyboard::GetInstance()->GetPressedKeys() & actions[action].keys).any();
+}
+
+bool InputActions::WasReleased(ActionId action) {
+	return (Keyboard::GetInstance()->GetReleasedKeys() & actions[action].keys).any();
+}
+
+int InputActions::Subscribe(ActionId action, std::function<void(bool down)> callback) {
+	int id = nextSubscriptionId++;
+
+	// Callbacks may subscribe, so the lists only grow outside of Update
+	if (dispatching) {
+		pendingSubscriptions.push_back({ action, { id, callback, false } });
+	}
+	else {
+		actions[action].subscriptions.push_back({ id, callback, false });
+	}
+	return id;
+}
+
+void InputActions::Unsubscribe(int subscription) {
+	std::erase_if(pendingSubscriptions, [subscription](PendingSubscription& pending) {
+		return pending.subscription.id == subscription;
+	});
+
+	// A callback may be running, so during Update it is only marked and its
+	// closure is destroyed after every callback returned
+	if (dispatching) {
+		for (Action& action : actions) {
+			for (Subscription& existing : action.subscriptions) {
+				if (existing.id == subscription) {
+					existing.removed = true;
+					hasUnsubscribed = true;
+				}
+			}
+		}
+		return;
+	}
+
+	for (Action& action : actions) {
+		std::erase_if(action.subscriptions, [subscription](Subscription& existing) {
+			return existing.id == subscription;
+		});
+	}
+}
+
+void InputActions::Update() {
+	if (!Keyboard::GetInstance()->HasChanged()) {
+		return;
+	}
+
+	dispatching = true;
+	for (ActionId id = 0; id < actions.size(); id++) {
+		bool down = IsDown(id);
+		// A key can go down and up between two frames, that still counts as a press
+		bool tapped = !down && !actions[id].down && WasPressed(id);
+		if (down == actions[id].down && !tapped) {
+			continue;
+		}
+
+		actions[id].down = down;
+		for (Subscription& subscription : actions[id].subscriptions) {
+			if (tapped && !subscription.removed) {
+				subscription.callback(true);
+			}
+			if (!subscription.removed) {
+				subscription.callback(down);
+			}
+		}
+	}
+	dispatching = false;
+
+	for (PendingSubscription& pending : pendingSubscriptions) {
+		actions[pending.action].subscriptions.push_back(pending.subscription);
+	}
+	pendingSubscriptions.clear();
+
+	if (hasUnsubscribed) {
+		for (Action& action : actions) {
+			std::erase_if(action.subscriptions, [](Subscription& subscription) {
+				return subscription.removed;
+			});
+		}
+		hasUnsubscribed = false;
+	}
+}
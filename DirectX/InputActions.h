@@ -0,0 +1,69 @@
+#ifndef H_INPUTACTIONS
+#define H_INPUTACTIONS
+#include <bitset>
+#include <functional>
+#include <string>
+#include <vector>
+#include "System.h"
+#include "Keyboard.h"
+
+typedef int ActionId;
+
+// Named actions bound to keys, e.g. "MoveForward" to 'W'. Queries are a few
+// bitset words, and subscribers are only called on the frame an action goes
+// down or up, nothing runs while the keyboard does not change.
+class InputActions : public System {
+public:
+	static InputActions* GetInstance();
+
+	static const int UPDATE_ORDER = UPDATE_ORDER_INPUT;
+
+	// Returns the existing action when the name is already taken. New actions
+	// cannot be added from a subscriber's callback.
+	ActionId AddAction(std::string name);
+	ActionId GetAction(std::string name);
+	const std::string& GetActionName(ActionId action);
+	void Bind(ActionId action, WPARAM key);
+	void Unbind(ActionId action, WPARAM key);
+
+	bool IsDown(ActionId action);
+	bool WasPressed(ActionId action);
+	bool WasReleased(ActionId action);
+
+	// The callback gets true when the action goes down and false when it goes up.
+	// Callbacks may subscribe and unsubscribe, even themselves, the changes
+	// apply once every callback of the frame was called.
+	int Subscribe(ActionId action, std::function<void(bool down)> callback);
+	void Unsubscribe(int subscription);
+
+	void Update() override;
+	int GetUpdateOrder() override;
+private:
+	InputActions();
+	inline static InputActions* instance;
+
+	struct Subscription {
+		int id;
+		std::function<void(bool down)> callback;
+		bool removed;			// Unsubscribed during Update, erased after it
+	};
+
+	struct Action {
+		std::string name;
+		std::bitset<Keyboard::KEY_COUNT> keys;
+		bool down;
+		std::vector<Subscription> subscriptions;
+	};
+
+	struct PendingSubscription {
+		ActionId action;
+		Subscription subscription;
+	};
+
+	std::vector<Action> actions;
+	int nextSubscriptionId;
+	bool dispatching;
+	std::vector<PendingSubscription> pendingSubscriptions;
+	bool hasUnsubscribed;
+};
+#endif
@@ -0,0 +1,119 @@
+#ifndef H_INPUTEVENT
+#define H_INPUTEVENT
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Binary layout of recorded input. Everything is little endian whatever the
+// platform, so recordings can be read anywhere:
+//   header   "DXIR", uint16 version, uint16 reserved
+//   records  one type byte followed by the payload of that type
+// A frame record starts every frame, the input events after it arrived during
+// that frame and are applied before the next one.
+#define INPUT_RECORDING_MAGIC "DXIR"
+#define INPUT_RECORDING_VERSION 1
+#define INPUT_RECORDING_HEADER_SIZE 8
+
+enum InputEventType : uint8_t {
+	INPUT_EVENT_FRAME = 0,		// float32 time since start
+	INPUT_EVENT_KEY_DOWN = 1,	// uint8 virtual key
+	INPUT_EVENT_KEY_UP = 2,		// uint8 virtual key
+	INPUT_EVENT_MOUSE_MOVE = 3,	// int32 x, int32 y
+};
+
+struct InputEvent {
+	InputEventType type;
+	float time;
+	uint8_t key;
+	int32_t x, y;
+};
+
+inline void WriteInputUInt32(std::vector<uint8_t>& out, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		out.push_back((uint8_t)(value >> (8 * i)));
+	}
+}
+
+inline uint32_t ReadInputUInt32(const uint8_t* data) {
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+inline void WriteInputHeader(std::vector<uint8_t>& out) {
+	out.insert(out.end(), INPUT_RECORDING_MAGIC, INPUT_RECORDING_MAGIC + 4);
+	out.push_back(INPUT_RECORDING_VERSION & 0xFF);
+	out.push_back(INPUT_RECORDING_VERSION >> 8);
+	out.push_back(0);
+	out.push_back(0);
+}
+
+inline bool IsInputHeaderValid(const uint8_t* data, size_t size) {
+	return size >= INPUT_RECORDING_HEADER_SIZE
+		&& memcmp(data, INPUT_RECORDING_MAGIC, 4) == 0
+		&& (data[4] | (data[5] << 8)) == INPUT_RECORDING_VERSION;
+}
+
+inline void WriteInputEvent(std::vector<uint8_t>& out, const InputEvent& event) {
+	out.push_back(event.type);
+	switch (event.type) {
+	case INPUT_EVENT_FRAME: {
+		uint32_t bits;
+		memcpy(&bits, &event.time, sizeof(bits));
+		WriteInputUInt32(out, bits);
+		break;
+	}
+	case INPUT_EVENT_KEY_DOWN:
+	case INPUT_EVENT_KEY_UP:
+		out.push_back(event.key);
+		break;
+	case INPUT_EVENT_MOUSE_MOVE:
+		WriteInputUInt32(out, (uint32_t)event.x);
+		WriteInputUInt32(out, (uint32_t)event.y);
+		break;
+	}
+}
+
+// Reads the event at offset and moves offset past it, false at the end of the
+// data or on a truncated or unknown record
+inline bool ReadInputEvent(const uint8_t* data, size_t size, size_t* offset, InputEvent* event) {
+	if (*offset >= size) {
+		return false;
+	}
+
+	size_t payloadSize;
+	event->type = (InputEventType)data[*offset];
+	switch (event->type) {
+	case INPUT_EVENT_FRAME:
+		payloadSize = 4;
+		break;
+	case INPUT_EVENT_KEY_DOWN:
+	case INPUT_EVENT_KEY_UP:
+		payloadSize = 1;
+		break;
+	case INPUT_EVENT_MOUSE_MOVE:
+		payloadSize = 8;
+		break;
+	default:
+		return false;
+	}
+
+	const uint8_t* payload = data + *offset + 1;
+	if (*offset + 1 + payloadSize > size) {
+		return false;
+	}
+
+	if (event->type == INPUT_EVENT_FRAME) {
+		uint32_t bits = ReadInputUInt32(payload);
+		memcpy(&event->time, &bits, sizeof(bits));
+	}
+	else if (event->type == INPUT_EVENT_MOUSE_MOVE) {
+		event->x = (int32_t)ReadInputUInt32(payload);
+		event->y = (int32_t)ReadInputUInt32(payload + 4);
+	}
+	else {
+		event->key = payload[0];
+	}
+
+	*offset += 1 + payloadSize;
+	return true;
+}
+#endif
@@ -0,0 +1,180 @@
+#include <iterator>
+#include "InputRecorder.h"
+#include "Main.h"
+#include "Clock.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+InputRecorder* InputRecorder::GetInstance() {
+	if (!instance) {
+		instance = new InputRecorder();
+	}
+	return instance;
+}
+
+InputRecorder::InputRecorder()
+	:
+	mode(Mode::Live),
+	frame(0),
+	replayFinished(false),
+	replayOffset(0)
+{}
+
+void InputRecorder::StartRecording(std::string path) {
+	Stop();
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not open " + path + " to record input");
+	}
+
+	WriteInputHeader(buffer);
+	mode = Mode::Recording;
+	frame = 0;
+}
+
+void InputRecorder::StartReplay(std::string path) {
+	Stop();
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not open " + path + " to replay input");
+	}
+	buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+	if (!IsInputHeaderValid(buffer.data(), buffer.size())) {
+		Main::HandleError(0, __FILE__, __LINE__, path + " is not an input recording of this version");
+	}
+
+	mode = Mode::Replaying;
+	frame = 0;
+	replayFinished = false;
+	replayOffset = INPUT_RECORDING_HEADER_SIZE;
+}
+
+void InputRecorder::Stop() {
+	if (mode == Mode::Recording) {
+		Flush();
+		file.close();
+	}
+	if (mode == Mode::Replaying) {
+		Clock::ClearManualTime();
+	}
+
+	buffer.clear();
+	mode = Mode::Live;
+}
+
+bool InputRecorder::IsRecording() {
+	return mode == Mode::Recording;
+}
+
+bool InputRecorder::IsReplaying() {
+	return mode == Mode::Replaying;
+}
+
+bool InputRecorder::IsReplayFinished() {
+	return replayFinished;
+}
+
+uint32_t InputRecorder::GetFrame() {
+	return frame;
+}
+
+void InputRecorder::BeginFrame() {
+	if (mode == Mode::Recording) {
+		// The frame sees one time from start to end, which is what the replay will see
+		float time = Clock::GetSingleton().GetRealTimeSinceStart();
+		Clock::SetManualTime(time);
+
+		InputEvent event = {};
+		event.type = INPUT_EVENT_FRAME;
+		event.time = time;
+		Record(event);
+		frame++;
+	}
+	else if (mode == Mode::Replaying) {
+		// Apply what arrived during the previous frame, up to the start of this one
+		InputEvent event;
+		while (ReadInputEvent(buffer.data(), buffer.size(), &replayOffset, &event)) {
+			if (event.type == INPUT_EVENT_FRAME) {
+				Clock::SetManualTime(event.time);
+				frame++;
+				return;
+			}
+			Apply(event);
+		}
+
+		Stop();
+		replayFinished = true;
+	}
+}
+
+void InputRecorder::OnKeyDown(WPARAM key) {
+	if (mode == Mode::Replaying || key > 0xFF) {
+		return;
+	}
+
+	InputEvent event = {};
+	event.type = INPUT_EVENT_KEY_DOWN;
+	event.key = (uint8_t)key;
+	Record(event);
+	Apply(event);
+}
+
+void InputRecorder::OnKeyUp(WPARAM key) {
+	if (mode == Mode::Replaying || key > 0xFF) {
+		return;
+	}
+
+	InputEvent event = {};
+	event.type = INPUT_EVENT_KEY_UP;
+	event.key = (uint8_t)key;
+	Record(event);
+	Apply(event);
+}
+
+void InputRecorder::OnMouseMove(int x, int y) {
+	if (mode == Mode::Replaying) {
+		return;
+	}
+
+	InputEvent event = {};
+	event.type = INPUT_EVENT_MOUSE_MOVE;
+	event.x = x;
+	event.y = y;
+	Record(event);
+	Apply(event);
+}
+
+void InputRecorder::Record(InputEvent event) {
+	if (mode != Mode::Recording) {
+		return;
+	}
+
+	WriteInputEvent(buffer, event);
+	if (buffer.size() >= FLUSH_SIZE) {
+		Flush();
+	}
+}
+
+void InputRecorder::Apply(InputEvent event) {
+	switch (event.type) {
+	case INPUT_EVENT_KEY_DOWN:
+		Keyboard::GetInstance()->InputStarted(event.key);
+		break;
+	case INPUT_EVENT_KEY_UP:
+		Keyboard::GetInstance()->InputStopped(event.key);
+		break;
+	case INPUT_EVENT_MOUSE_MOVE:
+		Mouse::GetInstance()->OnRawInput(event.x, event.y);
+		break;
+	default:
+		break;
+	}
+}
+
+void InputRecorder::Flush() {
+	file.write((const char*)buffer.data(), buffer.size());
+	buffer.clear();
+}
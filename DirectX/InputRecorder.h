@@ -0,0 +1,58 @@
+#ifndef H_INPUTRECORDER
+#define H_INPUTRECORDER
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <Windows.h>
+#include "InputEvent.h"
+
+// Sits between the message pump and Keyboard/Mouse. When recording it writes
+// every input event and the time of every frame to a file, when replaying it
+// ignores live input and feeds the file back instead, with the clock pinned to
+// the recorded frame times so a replay runs exactly like the recorded session.
+class InputRecorder {
+public:
+	static InputRecorder* GetInstance();
+
+	void StartRecording(std::string path);
+	void StartReplay(std::string path);
+	// Writes out what is left of a recording
+	void Stop();
+
+	bool IsRecording();
+	bool IsReplaying();
+	bool IsReplayFinished();
+	uint32_t GetFrame();
+
+	// Called at the start of every frame, before the game updates
+	void BeginFrame();
+
+	void OnKeyDown(WPARAM key);
+	void OnKeyUp(WPARAM key);
+	void OnMouseMove(int x, int y);
+private:
+	InputRecorder();
+	inline static InputRecorder* instance;
+
+	enum class Mode {
+		Live,
+		Recording,
+		Replaying
+	};
+
+	static const size_t FLUSH_SIZE = 64 * 1024;
+
+	Mode mode;
+	uint32_t frame;
+	bool replayFinished;
+	std::ofstream file;
+	// Pending records when recording, the whole file when replaying
+	std::vector<uint8_t> buffer;
+	size_t replayOffset;
+
+	void Record(InputEvent event);
+	void Apply(InputEvent event);
+	void Flush();
+};
+#endif
@@ -0,0 +1,166 @@
+#include "InputThread.h"
+#include "Main.h"
+#include "Clock.h"
+#include "InputRecorder.h"
+
+InputThread* InputThread::GetInstance() {
+	if (!instance) {
+		instance = new InputThread();
+	}
+	return instance;
+}
+
+InputThread::InputThread()
+	:
+	messageWindow(nullptr),
+	started(false),
+	registered(false),
+	gameWindow(nullptr),
+	droppedCount(0)
+{}
+
+void InputThread::Start(HWND gameWindow) {
+	this->gameWindow = gameWindow;
+	thread = std::thread(&InputThread::Run, this);
+
+	// Raw input gets registered on the thread, wait for it
+	while (!started.load()) {
+		std::this_thread::yield();
+	}
+
+	if (!registered) {
+		Stop();
+		Main::HandleError(0, __FILE__, __LINE__, "Failed to register the raw input devices");
+	}
+}
+
+void InputThread::Stop() {
+	if (!thread.joinable()) {
+		return;
+	}
+
+	PostMessage(messageWindow.load(), WM_CLOSE, 0, 0);
+	thread.join();
+}
+
+void InputThread::Drain(bool keyboardCaptured) {
+	InputEvent event;
+	while (queue.TryPop(&event)) {
+		switch (event.type) {
+		case INPUT_EVENT_KEY_DOWN:
+			// Releases always go through so no key stays stuck down
+			if (!keyboardCaptured) {
+				InputRecorder::GetInstance()->OnKeyDown(event.key);
+			}
+			break;
+		case INPUT_EVENT_KEY_UP:
+			InputRecorder::GetInstance()->OnKeyUp(event.key);
+			break;
+		case INPUT_EVENT_MOUSE_MOVE:
+			InputRecorder::GetInstance()->OnMouseMove(event.x, event.y);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+int InputThread::GetDroppedCount() {
+	return droppedCount;
+}
+
+void InputThread::Run() {
+	WNDCLASSEX wc;
+	ZeroMemory(&wc, sizeof(WNDCLASSEX));
+	wc.cbSize = sizeof(WNDCLASSEX);
+	wc.lpfnWndProc = WindowProc;
+	wc.hInstance = GetModuleHandle(NULL);
+	wc.lpszClassName = L"InputWindowClass";
+	RegisterClassEx(&wc);
+
+	HWND hWnd = CreateWindowEx(0, L"InputWindowClass", L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+	SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)this);
+
+	// A message-only window is never in the foreground, so it has to sink input
+	// and filter on the game window itself
+	RAWINPUTDEVICE devices[2];
+	ZeroMemory(devices, sizeof(devices));
+	devices[0].usUsagePage = 0x01;
+	devices[0].usUsage = 0x02;		// Mouse
+	devices[0].dwFlags = RIDEV_INPUTSINK;
+	devices[0].hwndTarget = hWnd;
+	devices[1].usUsagePage = 0x01;
+	devices[1].usUsage = 0x06;		// Keyboard
+	devices[1].dwFlags = RIDEV_INPUTSINK;
+	devices[1].hwndTarget = hWnd;
+	registered = RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE));
+
+	messageWindow = hWnd;
+	started = true;
+
+	MSG msg;
+	while (GetMessage(&msg, NULL, 0, 0) > 0) {
+		DispatchMessage(&msg);
+	}
+}
+
+LRESULT CALLBACK InputThread::WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+	InputThread* inputThread = (InputThread*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+
+	switch (message) {
+	case WM_INPUT:
+		if (inputThread) {
+			inputThread->OnRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+		}
+		break;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		return 0;
+	}
+
+	return DefWindowProc(hWnd, message, wParam, lParam);
+}
+
+void InputThread::OnRawInput(HRAWINPUT rawInputHandle) {
+	// Mouse and keyboard input always fit, no allocation per message
+	RAWINPUT rawInput;
+	UINT size = sizeof(rawInput);
+	if (GetRawInputData(rawInputHandle, RID_INPUT, &rawInput, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) {
+		return;
+	}
+
+	// Releases always go through, a key held while switching windows would
+	// otherwise stay down until pressed again
+	bool foreground = GetForegroundWindow() == gameWindow;
+
+	InputEvent event = {};
+	event.time = Clock::GetSingleton().GetRealTimeSinceStart();
+
+	if (rawInput.header.dwType == RIM_TYPEMOUSE) {
+		if (!foreground || (rawInput.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) {
+			return;
+		}
+		event.type = INPUT_EVENT_MOUSE_MOVE;
+		event.x = rawInput.data.mouse.lLastX;
+		event.y = rawInput.data.mouse.lLastY;
+		Push(event);
+	}
+	else if (rawInput.header.dwType == RIM_TYPEKEYBOARD) {
+		USHORT key = rawInput.data.keyboard.VKey;
+		if (key == 0 || key >= 0xFF) {
+			return;
+		}
+		event.type = (rawInput.data.keyboard.Flags & RI_KEY_BREAK) ? INPUT_EVENT_KEY_UP : INPUT_EVENT_KEY_DOWN;
+		if (!foreground && event.type == INPUT_EVENT_KEY_DOWN) {
+			return;
+		}
+		event.key = (uint8_t)key;
+		Push(event);
+	}
+}
+
+void InputThread::Push(InputEvent event) {
+	if (!queue.TryPush(event)) {
+		droppedCount++;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef H_INPUTTHREAD
+#define H_INPUTTHREAD
+#include <atomic>
+#include <thread>
+#include <Windows.h>
+#include "InputEvent.h"
+#include "SpscQueue.h"
+
+// Reads raw keyboard and mouse input on its own thread, through a message-only
+// window, and hands the events to the game thread through a lock-free queue.
+// Input is timestamped when it arrives instead of when the game gets around to
+// its message pump, and a long frame no longer delays reading it.
+class InputThread {
+public:
+	static InputThread* GetInstance();
+
+	// Only input arriving while gameWindow is in the foreground is kept, except
+	// key releases
+	void Start(HWND gameWindow);
+	void Stop();
+
+	// Game thread, passes every queued event to the InputRecorder
+	void Drain(bool keyboardCaptured);
+
+	int GetDroppedCount();
+private:
+	InputThread();
+	inline static InputThread* instance;
+
+	static const size_t QUEUE_SIZE = 1024;
+
+	std::thread thread;
+	std::atomic<HWND> messageWindow;
+	std::atomic<bool> started;
+	bool registered;
+	HWND gameWindow;
+	SpscQueue<InputEvent, QUEUE_SIZE> queue;
+	std::atomic<int> droppedCount;
+
+	void Run();
+	void OnRawInput(HRAWINPUT rawInputHandle);
+	void Push(InputEvent event);
+
+	static LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+};
+#endif
@@ -0,0 +1,157 @@
+#include "JobSystem.h"
+
+JobSystem* JobSystem::GetInstance() {
+	if (!instance) {
+		instance = new JobSystem();
+	}
+	return instance;
+}
+
+JobSystem::JobSystem()
+	:
+	queuedCount(0)
+{
+	// Leave one hardware thread for the main thread
+	int workerCount = (int)std::thread::hardware_concurrency() - 1;
+	if (workerCount < 0) {
+		workerCount = 0;
+	}
+
+	for (int i = 0; i <= workerCount; i++) {
+		workers.push_back(new Worker());
+	}
+
+	// The workers live as long as the process, like every other singleton
+	for (int i = 1; i <= workerCount; i++) {
+		std::thread(&JobSystem::WorkerLoop, this, i).detach();
+	}
+}
+
+int JobSystem::GetThreadCount() {
+	return workers.size();
+}
+
+void JobSystem::Push(Job* job) {
+	Worker* worker = workers[threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		worker->jobs.push_back(job);
+	}
+
+	// Taking the sleep mutex makes sure a worker that just found nothing is
+	// either still awake or already waiting, so it cannot miss this wake up
+	queuedCount++;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+JobSystem::Job* JobSystem::Pop() {
+	// Own jobs first, newest first so the data is still in cache
+	Worker* own = workers[threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(own->mutex);
+		if (own->jobs.size() > 0) {
+			Job* job = own->jobs.back();
+			own->jobs.pop_back();
+			queuedCount--;
+			return job;
+		}
+	}
+
+	// Then steal the oldest job of another thread
+	for (int i = 1; i < workers.size(); i++) {
+		Worker* victim = workers[(threadIndex + i) % workers.size()];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+		if (victim->jobs.size() > 0) {
+			Job* job = victim->jobs.front();
+			victim->jobs.pop_front();
+			queuedCount--;
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::Execute(Job* job) {
+	job->work();
+
+	// Queue the dependents before counting this job as done, otherwise a waiter
+	// could see every job finished while a dependent was never queued
+	for (Job* dependent : job->dependents) {
+		if (--dependent->pendingDependencies == 0) {
+			Push(dependent);
+		}
+	}
+	job->unfinished->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Wait(std::atomic<int>& unfinished) {
+	while (unfinished.load(std::memory_order_acquire) > 0) {
+		Job* job = Pop();
+		if (job) {
+			Execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(int index) {
+	threadIndex = index;
+
+	while (true) {
+		Job* job = Pop();
+		if (job) {
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this]() { return queuedCount.load() > 0; });
+	}
+}
+
+JobSystem::Graph::Graph()
+	:
+	unfinished(0)
+{}
+
+JobSystem::Graph::~Graph() {
+	for (Job* job : jobs) {
+		delete job;
+	}
+}
+
+int JobSystem::Graph::Add(std::function<void()> work, std::initializer_list<int> dependencies) {
+	Job* job = new Job();
+	job->work = work;
+	job->unfinished = &unfinished;
+	for (int dependency : dependencies) {
+		jobs[dependency]->dependents.push_back(job);
+		job->dependencyCount++;
+	}
+
+	jobs.push_back(job);
+	return jobs.size() - 1;
+}
+
+void JobSystem::Graph::Run() {
+	unfinished = jobs.size();
+	for (Job* job : jobs) {
+		job->pendingDependencies = job->dependencyCount;
+	}
+
+	for (Job* job : jobs) {
+		if (job->dependencyCount == 0) {
+			GetInstance()->Push(job);
+		}
+	}
+}
+
+void JobSystem::Graph::Wait() {
+	GetInstance()->Wait(unfinished);
+}
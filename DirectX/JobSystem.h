@@ -0,0 +1,98 @@
+#ifndef H_JOBSYSTEM
+#define H_JOBSYSTEM
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs work on a pool of worker threads. Every thread owns a deque, it pushes
+// and pops its own jobs at the back and steals from the front of the other
+// deques when it runs dry. A thread that waits for jobs runs jobs in the
+// meantime instead of blocking, so jobs can safely wait on other jobs.
+class JobSystem {
+	struct Job;
+public:
+	static JobSystem* GetInstance();
+
+	JobSystem(JobSystem& jobSystem) = delete;
+
+	// Jobs with dependencies between them. A job is queued once every job it
+	// depends on has finished.
+	class Graph {
+	public:
+		Graph();
+		~Graph();
+
+		// Returns the id to pass as a dependency of jobs added later
+		int Add(std::function<void()> work, std::initializer_list<int> dependencies = {});
+
+		void Run();
+		void Wait();
+	private:
+		std::vector<Job*> jobs;
+		std::atomic<int> unfinished;
+	};
+
+	// Calls function(begin, end) on batches of at most batchSize indices and
+	// returns when all of them are done
+	template<typename F>
+	void ParallelFor(int count, int batchSize, F function) {
+		int batchCount = (count + batchSize - 1) / batchSize;
+		if (batchCount <= 1 || workers.size() == 1) {
+			if (count > 0) {
+				function(0, count);
+			}
+			return;
+		}
+
+		std::atomic<int> unfinished(batchCount);
+		std::unique_ptr<Job[]> jobs(new Job[batchCount]);
+		for (int i = 0; i < batchCount; i++) {
+			int begin = i * batchSize;
+			int end = begin + batchSize < count ? begin + batchSize : count;
+			jobs[i].work = [&function, begin, end]() { function(begin, end); };
+			jobs[i].unfinished = &unfinished;
+			Push(&jobs[i]);
+		}
+		Wait(unfinished);
+	}
+
+	// Worker threads plus the main thread
+	int GetThreadCount();
+private:
+	JobSystem();
+	inline static JobSystem* instance;
+
+	// 0 for the main thread and any thread that is not a worker
+	inline static thread_local int threadIndex = 0;
+
+	struct Job {
+		std::function<void()> work;
+		std::atomic<int>* unfinished = nullptr;
+		int dependencyCount = 0;
+		std::atomic<int> pendingDependencies{ 0 };
+		std::vector<Job*> dependents;
+	};
+
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Job*> jobs;
+	};
+
+	std::vector<Worker*> workers;
+	std::atomic<int> queuedCount;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+
+	void Push(Job* job);
+	Job* Pop();
+	void Execute(Job* job);
+	void Wait(std::atomic<int>& unfinished);
+	void WorkerLoop(int index);
+};
+#endif
@@ -10,14 +10,51 @@ Keyboard* Keyboard::GetInstance() {
 
 Keyboard::Keyboard() {}
 
-set<WPARAM>* Keyboard::GetPressedKeys() {
-	return &pressedKeys;
+bool Keyboard::IsDown(WPARAM key) {
+	return key < KEY_COUNT && downKeys[key];
+}
+
+bool Keyboard::WasPressed(WPARAM key) {
+	return key < KEY_COUNT && pressedKeys[key];
+}
+
+bool Keyboard::WasReleased(WPARAM key) {
+	return key < KEY_COUNT && releasedKeys[key];
+}
+
+bool Keyboard::HasChanged() {
+	return pressedKeys.any() || releasedKeys.any();
+}
+
+const bitset<Keyboard::KEY_COUNT>& Keyboard::GetDownKeys() {
+	return downKeys;
+}
+
+const bitset<Keyboard::KEY_COUNT>& Keyboard::GetPressedKeys() {
+	return pressedKeys;
+}
+
+const bitset<Keyboard::KEY_COUNT>& Keyboard::GetReleasedKeys() {
+	return releasedKeys;
 }
 
 void Keyboard::InputStarted(WPARAM wParam) {
-	pressedKeys.insert(wParam);
+	if (wParam >= KEY_COUNT || downKeys[wParam]) {
+		return;
+	}
+	downKeys.set(wParam);
+	pressedKeys.set(wParam);
 }
 
 void Keyboard::InputStopped(WPARAM wParam) {
-	pressedKeys.erase(wParam);
+	if (wParam >= KEY_COUNT || !downKeys[wParam]) {
+		return;
+	}
+	downKeys.reset(wParam);
+	releasedKeys.set(wParam);
+}
+
+void Keyboard::EndFrame() {
+	pressedKeys.reset();
+	releasedKeys.reset();
 }
@@ -1,19 +1,37 @@
-#include <set>
+#ifndef H_KEYBOARD
+#define H_KEYBOARD
+#include <bitset>
 #include <Windows.h>
 
 using namespace std;
 
+// Key state indexed by virtual key code. Pressed and released only hold for
+// the frame after the key changed, EndFrame clears them.
 class Keyboard {
 public:
 	static Keyboard* GetInstance();
 
-	set<WPARAM>* GetPressedKeys();
+	static const int KEY_COUNT = 256;
+
+	bool IsDown(WPARAM key);
+	bool WasPressed(WPARAM key);
+	bool WasReleased(WPARAM key);
+	// Whether any key was pressed or released this frame
+	bool HasChanged();
+
+	const bitset<KEY_COUNT>& GetDownKeys();
+	const bitset<KEY_COUNT>& GetPressedKeys();
+	const bitset<KEY_COUNT>& GetReleasedKeys();
 
 	void InputStarted(WPARAM wParam);
 	void InputStopped(WPARAM wParam);
+	void EndFrame();
 private:
 	Keyboard();
 	inline static Keyboard* instance;
 
-	set<WPARAM> pressedKeys;
+	bitset<KEY_COUNT> downKeys;
+	bitset<KEY_COUNT> pressedKeys;
+	bitset<KEY_COUNT> releasedKeys;
 };
+#endif
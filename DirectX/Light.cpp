@@ -9,6 +9,10 @@ Light::Light(GameObject* gameObject)
 	Graphics::GetInstance()->AddLight(this);
 }
 
+Light::~Light() {
+	Graphics::GetInstance()->RemoveLight(this);
+}
+
 void Light::Update() {
 	btVector3 origin = gameObject->GetTransform().getOrigin();
 	float newPosition[4] = { origin.getX(), origin.getY(), origin.getZ() };
@@ -6,6 +6,14 @@
 class Light : public Component {
 public:
 	Light(GameObject* gameObject);
+	~Light();
+
+	static const ComponentType TYPE = COMPONENT_TYPE_LIGHT;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+	static const int UPDATE_ORDER = UPDATE_ORDER_LIGHT;
+	static const AccessMask READS = ACCESS_TRANSFORM;
+	static const AccessMask WRITES = ACCESS_LIGHTING;
+	static const bool PARALLEL_UPDATE = true;
 
 	void Update() override;
 
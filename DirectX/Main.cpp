@@ -11,13 +11,23 @@
 #include "Rigidbody.h"
 #include "Shape.h"
 #include "Script.h"
+#include "ScriptTask.h"
 #include "Keyboard.h"
+#include "InputActions.h"
+#include "InputRecorder.h"
+#include "InputThread.h"
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TextureCooker.h"
+#include "ImageBenchmark.h"
 #include "Gui.h"
 #include "Camera.h"
 #include "PositionConstraint.h"
 #include "Wedge.h"
 #include "Light.h"
+#include "SceneGenerator.h"
+#include "SceneCooker.h"
+#include "SceneLoader.h"
 
 int WINAPI WinMain(
     HINSTANCE hInstance,
@@ -26,23 +36,76 @@ int WINAPI WinMain(
     int nCmdShow
 ) {
     try {
+        // Offline cooking, exits without opening a window
+        //   "-cook-scene level.txt level.scene"
+        //   "-cook-texture brick.jpg brick.dds bc7", the format is bc1, bc3 or bc7
+        //   "-bench-image 4096" times the image kernels and shows the results
+        {
+            std::istringstream args(lpCmdLine);
+            std::string arg, sourcePath, cookedPath;
+            while (args >> arg) {
+                if (arg == "-cook-scene" && args >> sourcePath >> cookedPath) {
+                    SceneCooker::Cook(sourcePath, cookedPath);
+                    return 0;
+                }
+                if (arg == "-cook-texture" && args >> sourcePath >> cookedPath) {
+                    std::string formatName = "bc7";
+                    args >> formatName;
+
+                    TextureCooker::Format format;
+                    if (!TextureCooker::ParseFormat(formatName, &format)) {
+                        Main::HandleError(0, __FILE__, __LINE__, "Unknown texture format " + formatName);
+                    }
+                    TextureCooker::Cook(sourcePath, cookedPath, format);
+                    return 0;
+                }
+                if (arg == "-bench-image") {
+                    int size;
+                    if (!(args >> size) || size <= 0) {
+                        size = 4096;
+                    }
+                    MessageBoxA(NULL, ImageBenchmark::Run(size).c_str(), "Image benchmark", 0u);
+                    return 0;
+                }
+            }
+        }
+
         Window::Init(hInstance, hPrevInstance, lpCmdLine, nCmdShow);
         HWND hWnd = Window::GetInstance()->GetHandle();
         Game::Init(hWnd);
-        Physics::Init();
+        // "-physics-mt" steps the physics world on every JobSystem thread
+        {
+            bool multithreadedPhysics = false;
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            while (args >> arg) {
+                if (arg == "-physics-mt") {
+                    multithreadedPhysics = true;
+                }
+            }
+            Physics::Init(multithreadedPhysics);
+        }
         Graphics::Init(hWnd, 0.5f, 50.0f);
         Gui::Init(hWnd);
 
         Mouse::Init(hWnd);
 
-        FaceColor faceColors[] = {
-                { 1.0f, 0.0f, 0.0f, 1.0f },
-                { 0.0f, 1.0f, 0.0f, 1.0f },
-                { 0.0f, 0.0f, 1.0f, 1.0f },
-                { 1.0f, 0.0f, 0.0f, 1.0f },
-                { 1.0f, 0.0f, 1.0f, 1.0f },
-                { 1.0f, 1.0f, 0.0f, 1.0f },
-        };
+        InputActions* input = InputActions::GetInstance();
+        ActionId moveForward = input->AddAction("MoveForward");
+        ActionId moveBack = input->AddAction("MoveBack");
+        ActionId moveRight = input->AddAction("MoveRight");
+        ActionId moveLeft = input->AddAction("MoveLeft");
+        ActionId moveUp = input->AddAction("MoveUp");
+        ActionId moveDown = input->AddAction("MoveDown");
+        input->Bind(moveForward, 'W');
+        input->Bind(moveBack, 'S');
+        input->Bind(moveRight, 'D');
+        input->Bind(moveLeft, 'A');
+        input->Bind(moveUp, 'E');
+        input->Bind(moveDown, 'Q');
+
+        // Shared by the camera and player scripts, so it has to outlive this setup
+        btScalar yaw = 0, pitch = 0;
 
         // Camera
         {
@@ -64,7 +127,6 @@ int WINAPI WinMain(
             
             camera->AddComponent<Script>();
             Script* script = camera->GetComponent<Script>();
-            btScalar yaw = 0, pitch = 0;
             script->SetOnUpdate([&yaw, &pitch](GameObject* gameObject) {
                 float deltaTime = Clock::GetSingleton().GetTimeSinceStart() - Game::GetInstance()->GetLastUpdateTime();
                 btTransform oldTransform = gameObject->GetTransform();
@@ -102,13 +164,11 @@ int WINAPI WinMain(
                 rb->SetIsKinematic(false);
                 rb->SetAngularFactor(btVector3(0, 1, 0));
 
-                // Add constraint to camera
-                camera->AddComponent<PositionConstraint>();
-                PositionConstraint* positionConstraint = camera->GetComponent<PositionConstraint>();
-                positionConstraint->SetConstrainer(player);
+                // The camera follows the player's position but keeps its own rotation
+                camera->SetParent(player, false);
 
                 player->AddComponent<Script>();
-                player->GetComponent<Script>()->SetOnUpdate([rb, &yaw, &pitch](GameObject* gameObject) {
+                player->GetComponent<Script>()->SetOnUpdate([=, &yaw, &pitch](GameObject* gameObject) {
                     float deltaTime = Clock::GetSingleton().GetTimeSinceStart() - Game::GetInstance()->GetLastUpdateTime();
                     btTransform oldTransform = gameObject->GetTransform();
 
@@ -116,27 +176,23 @@ int WINAPI WinMain(
                     btVector3 translation(0, 0, 0);
                     btScalar translationMagnitude = 10000 * deltaTime;
 
-                    for (char key : *Keyboard::GetInstance()->GetPressedKeys()) {
-                        switch (key) {
-                        case 'W':
-                            translation.setZ(1);
-                            break;
-                        case 'S':
-                            translation.setZ(-1);
-                            break;
-                        case 'D':
-                            translation.setX(1);
-                            break;
-                        case 'A':
-                            translation.setX(-1);
-                            break;
-                        case 'E':
-                            translation.setY(1);
-                            break;
-                        case 'Q':
-                            translation.setY(-1);
-                            break;
-                        }
+                    if (input->IsDown(moveForward)) {
+                        translation.setZ(1);
+                    }
+                    if (input->IsDown(moveBack)) {
+                        translation.setZ(-1);
+                    }
+                    if (input->IsDown(moveRight)) {
+                        translation.setX(1);
+                    }
+                    if (input->IsDown(moveLeft)) {
+                        translation.setX(-1);
+                    }
+                    if (input->IsDown(moveUp)) {
+                        translation.setY(1);
+                    }
+                    if (input->IsDown(moveDown)) {
+                        translation.setY(-1);
                     }
 
                     // Make into unit
@@ -167,246 +223,105 @@ int WINAPI WinMain(
             }
         }
 
-        // Ground
+        // Texture memory limits in megabytes, "-texture-budget 256 512" for CPU and GPU
         {
-            btVector3 size(10, 1, 10);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(0, -2, 0));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
-
-            Texture* texture = new Texture("grass.jpg");
-            shape->SetTexture(texture);
-
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
-
-            object->AddComponent<Script>();
-            Script* script = object->GetComponent<Script>();
-            script->SetOnUpdate([rb](GameObject* gameObject) {
-                for (WPARAM wParam : *Keyboard::GetInstance()->GetPressedKeys()) {
-                    float deltaTime = Clock::GetSingleton().GetTimeSinceStart() - Game::GetInstance()->GetLastUpdateTime();
-                    btVector3 unitTorque(0, 0, 0);
-                    btScalar torqueMagnitude = 2.0f * deltaTime;
-
-                    if (wParam == 'W') {
-                        unitTorque.setY(1);
-                    }
-                    else if (wParam == 'S') {
-                        unitTorque.setY(-1);
-                    }
-                    else if (wParam == 'D') {
-                        unitTorque.setX(1);
-                    }
-                    else if (wParam == 'A') {
-                        unitTorque.setX(-1);
-                    }
-
-                    //rb->ApplyImpulse(unitTorque * torqueMagnitude);
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            size_t cpuMegabytes, gpuMegabytes;
+            while (args >> arg) {
+                if (arg == "-texture-budget" && args >> cpuMegabytes >> gpuMegabytes) {
+                    TextureCache::GetInstance()->SetBudget(cpuMegabytes * 1024 * 1024, gpuMegabytes * 1024 * 1024);
                 }
-                });
+            }
         }
 
-        // Wedge
+        // Physics rate, "-physics-rate 120 8" for 120 steps a second and up to 8 a frame
         {
-            btVector3 size(1, 1, 1);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(0, 0, 5));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Wedge>();
-            Shape* shape = object->GetComponent<Shape>();
-            shape->SetFaceColors(faceColors);
-
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
-
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(1);
-            rb->SetIsKinematic(false);
-
-            object->AddComponent<Script>();
-            Script* script = object->GetComponent<Script>();
-            script->SetOnUpdate([rb](GameObject* gameObject) {
-                for (WPARAM wParam : *Keyboard::GetInstance()->GetPressedKeys()) {
-                    float deltaTime = Clock::GetSingleton().GetTimeSinceStart() - Game::GetInstance()->GetLastUpdateTime();
-                    btVector3 unitTorque(0, 0, 0);
-                    btScalar torqueMagnitude = 2.0f * deltaTime;
-
-                    if (wParam == 'W') {
-                        unitTorque.setY(1);
-                    }
-                    else if (wParam == 'S') {
-                        unitTorque.setY(-1);
-                    }
-                    else if (wParam == 'D') {
-                        unitTorque.setX(1);
-                    }
-                    else if (wParam == 'A') {
-                        unitTorque.setX(-1);
-                    }
-
-                    //rb->ApplyImpulse(unitTorque * torqueMagnitude);
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            float stepsPerSecond;
+            int maxSteps;
+            while (args >> arg) {
+                if (arg == "-physics-rate" && args >> stepsPerSecond >> maxSteps && stepsPerSecond > 0 && maxSteps > 0) {
+                    Physics::GetInstance()->SetFixedTimeStep(1.0f / stepsPerSecond, maxSteps);
                 }
-                });
-
-
-            object->AddComponent<Light>();
+            }
         }
 
-        // Cube
+        // Level, "-scene level.scene" picks another one. A missing or outdated
+        // binary is cooked from the text scene of the same name.
         {
-            btVector3 size(0.1f, 0.1f, 0.1f);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(0, 0, -5));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
-
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
-
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
-
-            object->AddComponent<Light>();
-
-            object->AddComponent<Script>();
-            Script* script = object->GetComponent<Script>();
-            script->SetOnUpdate([rb](GameObject* gameObject) {
-                for (WPARAM wParam : *Keyboard::GetInstance()->GetPressedKeys()) {
-                    float deltaTime = Clock::GetSingleton().GetTimeSinceStart() - Game::GetInstance()->GetLastUpdateTime();
-                    btVector3 unitTorque(0, 0, 0);
-                    btScalar torqueMagnitude = 2.0f * deltaTime;
-
-                    if (wParam == 'W') {
-                        unitTorque.setY(1);
-                    }
-                    else if (wParam == 'S') {
-                        unitTorque.setY(-1);
-                    }
-                    else if (wParam == 'D') {
-                        unitTorque.setX(1);
-                    }
-                    else if (wParam == 'A') {
-                        unitTorque.setX(-1);
-                    }
-
-                    //rb->ApplyImpulse(unitTorque * torqueMagnitude);
+            std::string scenePath = "DefaultScene.scene";
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            while (args >> arg) {
+                if (arg == "-scene") {
+                    args >> scenePath;
                 }
-                });
-        }
-
-        // Wall S
-        {
-            btVector3 size(10, 3, 1);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(0, 0, -10));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
-
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
-            shape->SetFaceColors(faceColors);
-
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
-        }
-
-        // Wall N
-        {
-            btVector3 size(10, 3, 1);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(0, 0, 10));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
-
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
+            }
 
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
+            // Edited since it was last cooked when the text is newer
+            std::string textPath = scenePath.substr(0, scenePath.rfind('.')) + ".txt";
+            WIN32_FILE_ATTRIBUTE_DATA sceneInfo;
+            WIN32_FILE_ATTRIBUTE_DATA textInfo;
+            bool hasScene = GetFileAttributesExA(scenePath.c_str(), GetFileExInfoStandard, &sceneInfo);
+            bool hasText = GetFileAttributesExA(textPath.c_str(), GetFileExInfoStandard, &textInfo);
+            if (!hasScene || (hasText && CompareFileTime(&textInfo.ftLastWriteTime, &sceneInfo.ftLastWriteTime) > 0)) {
+                SceneCooker::Cook(textPath, scenePath);
+            }
+            SceneLoader::GetInstance()->Load(scenePath);
         }
 
-        // Wall E
+        // Procedural stress scene, e.g. "-stress 10000 42 pile"
         {
-            btVector3 size(1, 3, 10);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(10, 0, 0));
-
-            GameObject* object = new GameObject(transform, size);
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            while (args >> arg) {
+                if (arg != "-stress") {
+                    continue;
+                }
 
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
+                SceneGenerator::Config config;
+                config.origin = btVector3(0, 0, 30);
+                args >> config.objectCount >> config.seed;
 
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
+                std::string layout;
+                if (args >> layout && layout == "pile") {
+                    config.layout = SceneGenerator::Layout::Pile;
+                }
 
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
+                SceneGenerator(config).Generate();
+            }
         }
 
-        // Wall W
+        // Input capture for reproducible runs, "-record run.input" or "-replay run.input"
         {
-            btVector3 size(1, 3, 10);
-
-            btTransform transform;
-            transform.setIdentity();
-            transform.setOrigin(btVector3(-10, 0, 0));
-
-            GameObject* object = new GameObject(transform, size);
-
-            object->AddComponent<Cube>();
-            Shape* shape = object->GetComponent<Shape>();
-
-            Texture* texture = new Texture("brick.jpg");
-            shape->SetTexture(texture);
-
-            object->AddComponent<Rigidbody>();
-            Rigidbody* rb = object->GetComponent<Rigidbody>();
-            rb->SetMass(0);
-            rb->SetIsKinematic(true);
+            std::istringstream args(lpCmdLine);
+            std::string arg;
+            while (args >> arg) {
+                std::string path;
+                if (arg == "-record" && args >> path) {
+                    InputRecorder::GetInstance()->StartRecording(path);
+                }
+                else if (arg == "-replay" && args >> path) {
+                    InputRecorder::GetInstance()->StartReplay(path);
+                }
+            }
         }
 
         MSG msg = { 0 };
-        std::vector<BYTE> rawBuffer;
+        InputThread::GetInstance()->Start(hWnd);
         while (true)
         {
+            // Input that arrived during the last frame, drained before the recorder
+            // starts the next frame so a replay applies it at the same point
+            InputThread::GetInstance()->Drain(ImGui::GetIO().WantCaptureKeyboard);
+
+            InputRecorder::GetInstance()->BeginFrame();
+            if (InputRecorder::GetInstance()->IsReplayFinished()) {
+                goto mainLoopExit;
+            }
+
             const float t = Clock::GetSingleton().GetTimeSinceStart();
 
             std::ostringstream oss;
@@ -416,83 +331,25 @@ int WINAPI WinMain(
 
             Game::GetInstance()->Update();
 
-            // Reset the mouse rawinputstd::ostringstream oss;
+            // Reset the mouse rawinput
             Mouse::GetInstance()->SetRawInput(0, 0);
+            Keyboard::GetInstance()->EndFrame();
 
+            // Window messages only, game input comes from the InputThread
             while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
                 TranslateMessage(&msg);
                 DispatchMessage(&msg);
-                std::stringstream ss;
 
-                switch (msg.message) {
-                case WM_QUIT:
+                if (msg.message == WM_QUIT) {
                     goto mainLoopExit;
-                    break;
-                case WM_KEYDOWN:
-                    //ss << "User pressed: ";
-                    //ss << ((HIWORD(msg.lParam) & KF_REPEAT) == KF_REPEAT) << std::endl;
-                    //OutputDebugStringA(ss.str().c_str());
-
-                    if (ImGui::GetIO().WantCaptureKeyboard)
-                    {
-                        break;
-                    }
-
-                    if ((HIWORD(msg.lParam) & KF_REPEAT) != KF_REPEAT) {
-                        Keyboard::GetInstance()->InputStarted(msg.wParam);
-                    }
-                    break;
-                case WM_KEYUP:
-                    Keyboard::GetInstance()->InputStopped(msg.wParam);
-                    break;
-                case WM_INPUT:
-                    UINT size = 0u;
-                    // first get the size of the input data
-                    if (GetRawInputData(
-                        reinterpret_cast<HRAWINPUT>(msg.lParam),
-                        RID_INPUT,
-                        nullptr,
-                        &size,
-                        sizeof(RAWINPUTHEADER)) == -1
-                    ) {
-                        // bail msg processing if error
-                        break;
-                    }
-                    rawBuffer.resize(size);
-
-                    // read in the input data
-                    if (GetRawInputData(
-                        reinterpret_cast<HRAWINPUT>(msg.lParam),
-                        RID_INPUT,
-                        rawBuffer.data(),
-                        &size,
-                        sizeof(RAWINPUTHEADER)) != size
-                    )  {
-                        // bail msg processing if error
-                        break;
-                    }
-
-                    auto& ri = reinterpret_cast<const RAWINPUT&>(*rawBuffer.data());
-                    if (ri.header.dwType == RIM_TYPEMOUSE) {
-                        Mouse::GetInstance()->OnRawInput(ri.data.mouse.lLastX, ri.data.mouse.lLastY);
-
-                        std::ostringstream oss;
-                        oss << "User moved mouse: ";
-                        oss << Mouse::GetInstance()->GetRawInput()->x << ", " << Mouse::GetInstance()->GetRawInput()->y << std::endl;
-                        //SetWindowTextA(hWnd, oss.str().c_str());
-                    }
-
-
-                    //std::ostringstream oss;
-                    //oss << "Time elapsed: " << std::fixed << t << "s";
-                    //oss << "Mouse Position: " << std::fixed << "(" << mp.x << ", " << mp.y << ")";
-
-                    break;
                 }
             }
         }
 
         mainLoopExit:
+        InputThread::GetInstance()->Stop();
+        InputRecorder::GetInstance()->Stop();
+
         if (msg.wParam < 0) {
             throw new std::exception((const char*)GetLastError());
         }
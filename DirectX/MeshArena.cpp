@@ -0,0 +1,61 @@
+#include <new>
+#include "MeshArena.h"
+
+MeshArena* MeshArena::GetInstance() {
+	if (!instance) {
+		instance = new MeshArena();
+	}
+	return instance;
+}
+
+MeshArena::MeshArena()
+	:
+	stats("Mesh geometry"),
+	blockUsed(BLOCK_SIZE)
+{}
+
+void* MeshArena::Allocate(size_t size) {
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	stats.allocationCount++;
+	stats.liveBytes += size;
+
+	std::vector<void*>& freeList = freeLists[size];
+	if (freeList.size() > 0) {
+		void* pointer = freeList.back();
+		freeList.pop_back();
+		return pointer;
+	}
+
+	// Oversized meshes get a block of their own
+	if (size > BLOCK_SIZE) {
+		stats.heapAllocationCount++;
+		stats.reservedBytes += size;
+		return new (std::align_val_t(ALIGNMENT)) unsigned char[size];
+	}
+
+	if (blockUsed + size > BLOCK_SIZE) {
+		blocks.push_back(new (std::align_val_t(ALIGNMENT)) unsigned char[BLOCK_SIZE]);
+		blockUsed = 0;
+		stats.heapAllocationCount++;
+		stats.reservedBytes += BLOCK_SIZE;
+	}
+
+	void* pointer = blocks.back() + blockUsed;
+	blockUsed += size;
+	return pointer;
+}
+
+void MeshArena::Free(void* pointer, size_t size) {
+	if (!pointer) {
+		return;
+	}
+
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	stats.freeCount++;
+	stats.liveBytes -= size;
+	freeLists[size].push_back(pointer);
+}
+
+AllocatorStats* MeshArena::GetStats() {
+	return &stats;
+}
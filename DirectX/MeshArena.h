@@ -0,0 +1,31 @@
+#ifndef H_MESHARENA
+#define H_MESHARENA
+#include <vector>
+#include <unordered_map>
+#include "AllocatorStats.h"
+
+// Geometry storage for shapes. A mesh gets its vertices and indices in one
+// contiguous block carved out of large arena blocks. Freed blocks are kept per
+// size, and every mesh of one shape type has the same size, so respawning shapes
+// reuses memory instead of going to the global heap.
+class MeshArena {
+public:
+	static MeshArena* GetInstance();
+
+	void* Allocate(size_t size);
+	void Free(void* pointer, size_t size);
+
+	AllocatorStats* GetStats();
+private:
+	MeshArena();
+	inline static MeshArena* instance;
+
+	static const size_t BLOCK_SIZE = 256 * 1024;
+	static const size_t ALIGNMENT = 16;
+
+	AllocatorStats stats;
+	std::vector<unsigned char*> blocks;
+	size_t blockUsed;
+	std::unordered_map<size_t, std::vector<void*>> freeLists;
+};
+#endif
@@ -1,28 +1,31 @@
+#include <algorithm>
 #include "Physics.h"
 #include "Clock.h"
 #include "Game.h"
 #include "GameObject.h"
+#include "Rigidbody.h"
+#include "PhysicsTaskScheduler.h"
+#include "PhysicsSnapshot.h"
+#include "Main.h"
 
-void Physics::Init() {
-    instance = new Physics();
+void Physics::Init(bool multithreaded) {
+    instance = new Physics(multithreaded);
 }
 
 Physics* Physics::GetInstance() {
     return instance;
 }
 
-Physics::Physics() {
-    // Create the configuration
-    btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
-    // Create the collision dispatcher
-    btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
-    // ???
-    btBroadphaseInterface* overlappingPairCache = new btDbvtBroadphase();
-    // Constraint solver
-    btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver();
-    // Create the world
-    this->dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher,
-        overlappingPairCache, solver, collisionConfiguration);
+Physics::Physics(bool multithreaded)
+    :
+    dynamicsWorld(PhysicsTaskScheduler::CreateWorld(multithreaded)),
+    fixedTimeStep(1.0f / 60.0f),
+    maxSteps(4),
+    lastTime(0),
+    accumulator(0),
+    interpolation(0),
+    stepCount(0)
+{
     // Set the gravity
     this->dynamicsWorld->setGravity(btVector3(0, -9.81f, 0));
 }
@@ -36,9 +39,94 @@ void Physics::RemoveRigidbody(btRigidBody* rigidbody) {
 }
 
 void Physics::Update() {
-    static float last = Clock::GetSingleton().GetTimeSinceStart();
-    this->dynamicsWorld->stepSimulation(Clock::GetSingleton().GetTimeSinceStart() - last, 10);
-    last = Clock::GetSingleton().GetTimeSinceStart();
+    for (Rigidbody* rigidbody : pendingColliders) {
+        rigidbody->ResolveCollider();
+    }
+    pendingColliders.clear();
+
+    float now = Clock::GetSingleton().GetTimeSinceStart();
+    accumulator += now - lastTime;
+    lastTime = now;
+    accumulator = std::min(accumulator, maxSteps * fixedTimeStep);
+
+    while (accumulator >= fixedTimeStep) {
+        // No substeps of its own, Bullet steps exactly once
+        stepCount++;
+        dynamicsWorld->stepSimulation(fixedTimeStep, 0);
+        accumulator -= fixedTimeStep;
+    }
+
+    interpolation = accumulator / fixedTimeStep;
+
+    // Bodies that came to rest get their final transform and leave the list
+    for (int i = 0; i < movedBodies.size(); i++) {
+        if (!movedBodies[i]->SyncTransform(stepCount, interpolation)) {
+            movedBodies[i] = movedBodies.back();
+            movedBodies.pop_back();
+            i--;
+        }
+    }
+}
+
+btDiscreteDynamicsWorld* Physics::GetDynamicsWorld() {
+    return dynamicsWorld;
+}
+
+void Physics::SaveSnapshot(PhysicsSnapshot* snapshot) {
+    snapshot->Save(dynamicsWorld);
+}
+
+void Physics::RestoreSnapshot(const PhysicsSnapshot& snapshot) {
+    if (!snapshot.Restore(dynamicsWorld)) {
+        Main::HandleError(0, __FILE__, __LINE__, "Physics snapshot does not match the bodies in the world");
+    }
+}
+
+int Physics::GetStepCount() {
+    return stepCount;
+}
+
+void Physics::MarkMoved(Rigidbody* rigidbody) {
+    movedBodies.push_back(rigidbody);
+}
+
+void Physics::ForgetMoved(Rigidbody* rigidbody) {
+    auto found = std::find(movedBodies.begin(), movedBodies.end(), rigidbody);
+    if (found != movedBodies.end()) {
+        *found = movedBodies.back();
+        movedBodies.pop_back();
+    }
+}
+
+void Physics::AddPendingCollider(Rigidbody* rigidbody) {
+    pendingColliders.push_back(rigidbody);
+}
+
+void Physics::ForgetPendingCollider(Rigidbody* rigidbody) {
+    auto found = std::find(pendingColliders.begin(), pendingColliders.end(), rigidbody);
+    if (found != pendingColliders.end()) {
+        *found = pendingColliders.back();
+        pendingColliders.pop_back();
+    }
+}
+
+void Physics::SetFixedTimeStep(float seconds, int maxSteps) {
+    fixedTimeStep = seconds;
+    this->maxSteps = maxSteps;
+}
+
+void Physics::ResetClock() {
+    lastTime = Clock::GetSingleton().GetTimeSinceStart();
+    accumulator = 0;
+    interpolation = 0;
+}
+
+float Physics::GetFixedTimeStep() {
+    return fixedTimeStep;
+}
+
+float Physics::GetInterpolation() {
+    return interpolation;
 }
 
 Physics::~Physics() {
@@ -1,20 +1,69 @@
 #ifndef H_PHYSICS
 #define H_PHYSICS
+#include <vector>
 #include "btBulletDynamicsCommon.h"
 
+class PhysicsSnapshot;
+class Rigidbody;
+
+// Steps the Bullet world at a fixed rate, however long frames take. Frame
+// time is banked and spent in whole steps, at most maxSteps a frame, and
+// Rigidbodies draw between the last two steps by the time left over. Only
+// bodies Bullet moved are written back to their GameObjects.
 class Physics {
 public:
-	static void Init();
+	// Multithreaded steps the world on the JobSystem threads
+	static void Init(bool multithreaded);
 	static Physics* GetInstance();
 
 	void AddRigidbody(btRigidBody* rigidbody);
 	void RemoveRigidbody(btRigidBody* rigidbody);
 	void Update();
+
+	// For queries between steps, see PhysicsQuery
+	btDiscreteDynamicsWorld* GetDynamicsWorld();
+
+	// Rolls the world back to where it was when the snapshot was saved,
+	// between frames only. Bodies added or removed since are an error.
+	void SaveSnapshot(PhysicsSnapshot* snapshot);
+	void RestoreSnapshot(const PhysicsSnapshot& snapshot);
+
+	// 60 steps a second and up to 4 of them a frame by default, a slower
+	// frame drops the rest of its time instead of catching up
+	void SetFixedTimeStep(float seconds, int maxSteps);
+	float GetFixedTimeStep();
+
+	// Starts banking time from now, the first frame steps nothing
+	void ResetClock();
+
+	// How far the time not stepped yet is into the next step, 0 to 1
+	float GetInterpolation();
+
+	// Steps taken so far, a body moved during step n reports n
+	int GetStepCount();
+
+	// Bodies whose transforms changed, synced to their GameObjects after
+	// stepping until they come to rest
+	void MarkMoved(Rigidbody* rigidbody);
+	void ForgetMoved(Rigidbody* rigidbody);
+
+	// Bodies still on their placeholder box, given their collider before stepping
+	void AddPendingCollider(Rigidbody* rigidbody);
+	void ForgetPendingCollider(Rigidbody* rigidbody);
 private:
-	Physics();
+	Physics(bool multithreaded);
 	~Physics();
 	inline static Physics* instance;
 
 	btDiscreteDynamicsWorld* dynamicsWorld;
+
+	float fixedTimeStep;
+	int maxSteps;
+	float lastTime;
+	float accumulator;
+	float interpolation;
+	int stepCount;
+	std::vector<Rigidbody*> movedBodies;
+	std::vector<Rigidbody*> pendingColliders;
 };
 #endif
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include "PhysicsQuery.h"
+#include "JobSystem.h"
+#include "Physics.h"
+#include "Rigidbody.h"
+#include "LinearMath/btAabbUtil2.h"
+
+namespace {
+	// Keeps the closest bounding box along the ray, the same clipping Bullet
+	// does before testing shapes
+	class BroadphaseRayCallback : public btBroadphaseRayCallback {
+	public:
+		BroadphaseRayCallback(const btVector3& from, const btVector3& to)
+			:
+			from(from),
+			to(to),
+			closest(1),
+			object(nullptr)
+		{
+			btVector3 direction = (to - from).normalized();
+			for (int i = 0; i < 3; i++) {
+				m_rayDirectionInverse[i] = direction[i] == 0 ? btScalar(BT_LARGE_FLOAT) : 1 / direction[i];
+				m_signs[i] = m_rayDirectionInverse[i] < 0;
+			}
+			m_lambda_max = direction.dot(to - from);
+		}
+
+		bool process(const btBroadphaseProxy* proxy) override {
+			// Only boxes entered before the closest one so far
+			btScalar fraction = closest;
+			btVector3 hitNormal;
+			if (btRayAabb(from, to, proxy->m_aabbMin, proxy->m_aabbMax, fraction, hitNormal)) {
+				closest = fraction;
+				normal = hitNormal;
+				object = (const btCollisionObject*)proxy->m_clientObject;
+			}
+			return true;
+		}
+
+		btVector3 from;
+		btVector3 to;
+		btScalar closest;
+		btVector3 normal;
+		const btCollisionObject* object;
+	};
+
+	class BroadphaseAabbCallback : public btBroadphaseAabbCallback {
+	public:
+		BroadphaseAabbCallback(std::vector<const btCollisionObject*>* objects)
+			:
+			objects(objects)
+		{}
+
+		bool process(const btBroadphaseProxy* proxy) override {
+			objects->push_back((const btCollisionObject*)proxy->m_clientObject);
+			return true;
+		}
+
+		std::vector<const btCollisionObject*>* objects;
+	};
+
+	class ContactCallback : public btCollisionWorld::ContactResultCallback {
+	public:
+		ContactCallback(const btCollisionObject* probe, std::vector<const btCollisionObject*>* objects)
+			:
+			probe(probe),
+			objects(objects)
+		{}
+
+		btScalar addSingleResult(btManifoldPoint& point, const btCollisionObjectWrapper* wrapper0, int partId0, int index0, const btCollisionObjectWrapper* wrapper1, int partId1, int index1) override {
+			const btCollisionObject* object = wrapper0->getCollisionObject() == probe ? wrapper1->getCollisionObject() : wrapper0->getCollisionObject();
+
+			// Contact points of one pair arrive together, the object is listed once
+			if (objects->empty() || objects->back() != object) {
+				objects->push_back(object);
+			}
+			return 0;
+		}
+
+		const btCollisionObject* probe;
+		std::vector<const btCollisionObject*>* objects;
+	};
+}
+
+btDiscreteDynamicsWorld* PhysicsQuery::GetWorld() {
+	return Physics::GetInstance()->GetDynamicsWorld();
+}
+
+GameObject* PhysicsQuery::GetGameObject(const btCollisionObject* collisionObject) {
+	Rigidbody* rigidbody = (Rigidbody*)collisionObject->getUserPointer();
+	return rigidbody ? rigidbody->GetGameObject() : nullptr;
+}
+
+PhysicsQuery::Hit PhysicsQuery::Miss(const btVector3& to) {
+	return { nullptr, to, btVector3(0, 0, 0), 1 };
+}
+
+void PhysicsQuery::Raycast(const Ray* rays, int count, Hit* hits, Accuracy accuracy) {
+	btDiscreteDynamicsWorld* world = GetWorld();
+
+	// The broadphase keeps a ray stack per thread, so rays may be cast from every thread
+	JobSystem::GetInstance()->ParallelFor(count, BATCH_SIZE, [world, rays, hits, accuracy](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const Ray& ray = rays[i];
+			hits[i] = Miss(ray.to);
+
+			if (accuracy == Accuracy::BROADPHASE) {
+				BroadphaseRayCallback callback(ray.from, ray.to);
+				world->getBroadphase()->rayTest(ray.from, ray.to, callback);
+				if (callback.object) {
+					hits[i] = { GetGameObject(callback.object), ray.from.lerp(ray.to, callback.closest), callback.normal, callback.closest };
+				}
+				continue;
+			}
+
+			btCollisionWorld::ClosestRayResultCallback callback(ray.from, ray.to);
+			world->rayTest(ray.from, ray.to, callback);
+			if (callback.hasHit()) {
+				hits[i] = { GetGameObject(callback.m_collisionObject), callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction };
+			}
+		}
+	});
+}
+
+void PhysicsQuery::ConvexSweep(const Sweep* sweeps, int count, Hit* hits) {
+	btDiscreteDynamicsWorld* world = GetWorld();
+
+	JobSystem::GetInstance()->ParallelFor(count, BATCH_SIZE, [world, sweeps, hits](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const Sweep& sweep = sweeps[i];
+			hits[i] = Miss(sweep.to.getOrigin());
+
+			btCollisionWorld::ClosestConvexResultCallback callback(sweep.from.getOrigin(), sweep.to.getOrigin());
+			world->convexSweepTest(sweep.shape, sweep.from, sweep.to, callback);
+			if (callback.hasHit()) {
+				hits[i] = { GetGameObject(callback.m_hitCollisionObject), callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction };
+			}
+		}
+	});
+}
+
+void PhysicsQuery::Overlap(const Box* boxes, int count, Range* ranges, std::vector<GameObject*>* objects, Accuracy accuracy) {
+	if (accuracy == Accuracy::EXACT) {
+		for (int i = 0; i < count; i++) {
+			ranges[i].first = (int)objects->size();
+			OverlapExact(boxes[i], objects);
+			ranges[i].count = (int)objects->size() - ranges[i].first;
+		}
+		return;
+	}
+
+	// Every batch fills its own list with ranges relative to it, the lists are
+	// then joined in order and the ranges moved along
+	int batchCount = (count + BATCH_SIZE - 1) / BATCH_SIZE;
+	std::vector<std::vector<GameObject*>> batchObjects(batchCount);
+	JobSystem::GetInstance()->ParallelFor(count, BATCH_SIZE, [boxes, ranges, &batchObjects](int begin, int end) {
+		std::vector<GameObject*>& found = batchObjects[begin / BATCH_SIZE];
+		for (int i = begin; i < end; i++) {
+			ranges[i].first = (int)found.size();
+			OverlapBroadphase(boxes[i], &found);
+			ranges[i].count = (int)found.size() - ranges[i].first;
+		}
+	});
+
+	for (int batch = 0; batch < batchCount; batch++) {
+		int offset = (int)objects->size();
+		int end = std::min((batch + 1) * BATCH_SIZE, count);
+		for (int i = batch * BATCH_SIZE; i < end; i++) {
+			ranges[i].first += offset;
+		}
+		objects->insert(objects->end(), batchObjects[batch].begin(), batchObjects[batch].end());
+	}
+}
+
+void PhysicsQuery::OverlapBroadphase(const Box& box, std::vector<GameObject*>* objects) {
+	thread_local std::vector<const btCollisionObject*> found;
+	found.clear();
+
+	BroadphaseAabbCallback callback(&found);
+	GetWorld()->getBroadphase()->aabbTest(box.min, box.max, callback);
+	for (const btCollisionObject* object : found) {
+		objects->push_back(GetGameObject(object));
+	}
+}
+
+void PhysicsQuery::OverlapExact(const Box& box, std::vector<GameObject*>* objects) {
+	// A box shaped probe that is never added to the world
+	btBoxShape shape((box.max - box.min) * 0.5f);
+	btCollisionObject probe;
+	probe.setCollisionShape(&shape);
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin((box.min + box.max) * 0.5f);
+	probe.setWorldTransform(transform);
+
+	std::vector<const btCollisionObject*> found;
+	ContactCallback callback(&probe, &found);
+	GetWorld()->contactTest(&probe, callback);
+	for (const btCollisionObject* object : found) {
+		objects->push_back(GetGameObject(object));
+	}
+}
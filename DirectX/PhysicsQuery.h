@@ -0,0 +1,70 @@
+#ifndef H_PHYSICSQUERY
+#define H_PHYSICSQUERY
+#include <vector>
+#include "btBulletDynamicsCommon.h"
+
+class GameObject;
+
+// Batched raycasts, convex sweeps and box overlaps against the physics world.
+// Queries go in as arrays and results come out in arrays of the same order,
+// result i answering query i. Batches are spread over the JobSystem threads,
+// so they are meant for scripts and systems, never while the world steps.
+class PhysicsQuery {
+public:
+	enum class Accuracy {
+		// Bounding boxes of the broadphase only, cheap but coarse
+		BROADPHASE,
+		// The collision shapes themselves
+		EXACT,
+	};
+
+	struct Ray {
+		btVector3 from;
+		btVector3 to;
+	};
+
+	// The shape is only read, one shape may be swept by many queries at once
+	struct Sweep {
+		const btConvexShape* shape;
+		btTransform from;
+		btTransform to;
+	};
+
+	struct Box {
+		btVector3 min;
+		btVector3 max;
+	};
+
+	// The closest hit, gameObject is null and fraction 1 when nothing was hit.
+	// Broadphase hits are where the ray enters a bounding box.
+	struct Hit {
+		GameObject* gameObject;
+		btVector3 point;
+		btVector3 normal;
+		btScalar fraction;
+	};
+
+	// Where the objects overlapping a box are in the objects array
+	struct Range {
+		int first;
+		int count;
+	};
+
+	static void Raycast(const Ray* rays, int count, Hit* hits, Accuracy accuracy = Accuracy::EXACT);
+	static void ConvexSweep(const Sweep* sweeps, int count, Hit* hits);
+
+	// Objects overlapping each box are appended to objects. Exact overlaps
+	// make contact manifolds, which Bullet does not allow from several
+	// threads outside of a step, so they run on the calling thread.
+	static void Overlap(const Box* boxes, int count, Range* ranges, std::vector<GameObject*>* objects, Accuracy accuracy = Accuracy::BROADPHASE);
+private:
+	// Enough queries in a batch to outweigh handing it to another thread
+	static const int BATCH_SIZE = 32;
+
+	static btDiscreteDynamicsWorld* GetWorld();
+	static GameObject* GetGameObject(const btCollisionObject* collisionObject);
+	static Hit Miss(const btVector3& to);
+	static void OverlapBroadphase(const Box& box, std::vector<GameObject*>* objects);
+	static void OverlapExact(const Box& box, std::vector<GameObject*>* objects);
+};
+#endif
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <functional>
+#include "PhysicsSnapshot.h"
+
+void PhysicsSnapshot::Save(btDiscreteDynamicsWorld* world) {
+	bodies.clear();
+	manifolds.clear();
+	points.clear();
+
+	btCollisionObjectArray& collisionObjects = world->getCollisionObjectArray();
+	for (int i = 0; i < collisionObjects.size(); i++) {
+		btRigidBody* rigidbody = btRigidBody::upcast(collisionObjects[i]);
+		if (!rigidbody) {
+			continue;
+		}
+
+		Body body;
+		body.rigidbody = rigidbody;
+		body.transform = rigidbody->getWorldTransform();
+		body.interpolationTransform = rigidbody->getInterpolationWorldTransform();
+		body.linearVelocity = rigidbody->getLinearVelocity();
+		body.angularVelocity = rigidbody->getAngularVelocity();
+		body.interpolationLinearVelocity = rigidbody->getInterpolationLinearVelocity();
+		body.interpolationAngularVelocity = rigidbody->getInterpolationAngularVelocity();
+		body.deactivationTime = rigidbody->getDeactivationTime();
+		body.activationState = rigidbody->getActivationState();
+		bodies.push_back(body);
+	}
+
+	// Contact points keep the impulses of the last step, without them the
+	// first step after a restore starts cold and stacks jitter
+	btDispatcher* dispatcher = world->getDispatcher();
+	for (int i = 0; i < dispatcher->getNumManifolds(); i++) {
+		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+		if (manifold->getNumContacts() == 0) {
+			continue;
+		}
+
+		manifolds.push_back({ manifold->getBody0(), manifold->getBody1(), (int)points.size(), manifold->getNumContacts() });
+		for (int j = 0; j < manifold->getNumContacts(); j++) {
+			points.push_back(manifold->getContactPoint(j));
+		}
+	}
+	std::sort(manifolds.begin(), manifolds.end(), ComesBefore);
+}
+
+bool PhysicsSnapshot::Restore(btDiscreteDynamicsWorld* world) const {
+	// The same bodies in the same order, or the snapshot belongs to another world
+	btCollisionObjectArray& collisionObjects = world->getCollisionObjectArray();
+	int bodyIndex = 0;
+	for (int i = 0; i < collisionObjects.size(); i++) {
+		btRigidBody* rigidbody = btRigidBody::upcast(collisionObjects[i]);
+		if (rigidbody && (bodyIndex >= bodies.size() || bodies[bodyIndex++].rigidbody != rigidbody)) {
+			return false;
+		}
+	}
+	if (bodyIndex != bodies.size()) {
+		return false;
+	}
+
+	for (const Body& body : bodies) {
+		btRigidBody* rigidbody = body.rigidbody;
+		rigidbody->setWorldTransform(body.transform);
+		rigidbody->setInterpolationWorldTransform(body.interpolationTransform);
+		rigidbody->setLinearVelocity(body.linearVelocity);
+		rigidbody->setAngularVelocity(body.angularVelocity);
+		rigidbody->setInterpolationLinearVelocity(body.interpolationLinearVelocity);
+		rigidbody->setInterpolationAngularVelocity(body.interpolationAngularVelocity);
+		rigidbody->clearForces();
+		rigidbody->forceActivationState(body.activationState);
+		rigidbody->setDeactivationTime(body.deactivationTime);
+
+		// Twice, so the body is drawn where it was put instead of between
+		// there and where it is now. Kinematic bodies are read back from here.
+		if (btMotionState* motionState = rigidbody->getMotionState()) {
+			motionState->setWorldTransform(body.transform);
+			motionState->setWorldTransform(body.transform);
+		}
+
+		// Moves the broadphase box, pairs follow on the next step
+		world->updateSingleAabb(rigidbody);
+	}
+
+	// Manifolds of pairs that touched at the snapshot get their points back,
+	// the others are emptied. Pairs that no longer overlap are dropped by the
+	// next step, pairs that overlap again start without warm starting.
+	btDispatcher* dispatcher = world->getDispatcher();
+	for (int i = 0; i < dispatcher->getNumManifolds(); i++) {
+		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+		manifold->clearManifold();
+
+		const Manifold* saved = FindManifold(manifold->getBody0(), manifold->getBody1());
+		if (!saved) {
+			continue;
+		}
+		for (int j = 0; j < saved->count; j++) {
+			manifold->getContactPoint(j) = points[saved->first + j];
+		}
+		manifold->setNumContacts(saved->count);
+	}
+	return true;
+}
+
+size_t PhysicsSnapshot::GetSize() const {
+	return bodies.capacity() * sizeof(Body) + manifolds.capacity() * sizeof(Manifold) + points.capacity() * sizeof(btManifoldPoint);
+}
+
+const PhysicsSnapshot::Manifold* PhysicsSnapshot::FindManifold(const btCollisionObject* body0, const btCollisionObject* body1) const {
+	Manifold key = { body0, body1, 0, 0 };
+	auto found = std::lower_bound(manifolds.begin(), manifolds.end(), key, ComesBefore);
+	if (found == manifolds.end() || found->body0 != body0 || found->body1 != body1) {
+		return nullptr;
+	}
+	return &*found;
+}
+
+bool PhysicsSnapshot::ComesBefore(const Manifold& a, const Manifold& b) {
+	std::less<const btCollisionObject*> less;
+	return a.body0 != b.body0 ? less(a.body0, b.body0) : less(a.body1, b.body1);
+}
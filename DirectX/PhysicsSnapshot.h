@@ -0,0 +1,48 @@
+#ifndef H_PHYSICSSNAPSHOT
+#define H_PHYSICSSNAPSHOT
+#include <vector>
+#include "btBulletDynamicsCommon.h"
+
+// The dynamic state of every body in a world, kept in flat arrays: transforms,
+// velocities, activation and the contact points the solver warm starts from.
+// Taking a snapshot again reuses the arrays, so after the first one saving and
+// restoring only copy memory. A snapshot restores into the world it was taken
+// from, with the same bodies in it, and never while that world steps.
+class PhysicsSnapshot {
+public:
+	void Save(btDiscreteDynamicsWorld* world);
+
+	// False, leaving the world as it was, when bodies were added or removed since
+	bool Restore(btDiscreteDynamicsWorld* world) const;
+
+	// Bytes held by the arrays
+	size_t GetSize() const;
+private:
+	struct Body {
+		btRigidBody* rigidbody;
+		btTransform transform;
+		btTransform interpolationTransform;
+		btVector3 linearVelocity;
+		btVector3 angularVelocity;
+		btVector3 interpolationLinearVelocity;
+		btVector3 interpolationAngularVelocity;
+		btScalar deactivationTime;
+		int activationState;
+	};
+
+	// Points of one contact manifold, sorted by body pair so Restore finds them
+	struct Manifold {
+		const btCollisionObject* body0;
+		const btCollisionObject* body1;
+		int first;
+		int count;
+	};
+
+	std::vector<Body> bodies;
+	std::vector<Manifold> manifolds;
+	std::vector<btManifoldPoint> points;
+
+	static bool ComesBefore(const Manifold& a, const Manifold& b);
+	const Manifold* FindManifold(const btCollisionObject* body0, const btCollisionObject* body1) const;
+};
+#endif
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <vector>
+#include "PhysicsTaskScheduler.h"
+#include "JobSystem.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+
+PhysicsTaskScheduler* PhysicsTaskScheduler::GetInstance() {
+	if (!instance) {
+		instance = new PhysicsTaskScheduler();
+	}
+	return instance;
+}
+
+PhysicsTaskScheduler::PhysicsTaskScheduler()
+	:
+	btITaskScheduler("JobSystem"),
+	activeThreadCount(JobSystem::GetInstance()->GetThreadCount())
+{}
+
+int PhysicsTaskScheduler::getMaxNumThreads() const {
+	return JobSystem::GetInstance()->GetThreadCount();
+}
+
+int PhysicsTaskScheduler::getNumThreads() const {
+	// Any JobSystem thread may steal a batch, whatever the active count
+	return getMaxNumThreads();
+}
+
+void PhysicsTaskScheduler::setNumThreads(int numThreads) {
+	activeThreadCount = std::min(std::max(numThreads, 1), getMaxNumThreads());
+}
+
+int PhysicsTaskScheduler::GetBatchSize(int count, int grainSize) const {
+	// No more batches than active threads, and none smaller than Bullet asks for
+	int batchSize = (count + activeThreadCount - 1) / activeThreadCount;
+	return std::max(batchSize, std::max(grainSize, 1));
+}
+
+void PhysicsTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) {
+	int count = iEnd - iBegin;
+	JobSystem::GetInstance()->ParallelFor(count, GetBatchSize(count, grainSize), [&body, iBegin](int begin, int end) {
+		body.forLoop(iBegin + begin, iBegin + end);
+	});
+}
+
+btScalar PhysicsTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) {
+	int count = iEnd - iBegin;
+	int batchSize = GetBatchSize(count, grainSize);
+
+	// One slot per batch, added up in order so the result does not depend on timing
+	std::vector<btScalar> sums((count + batchSize - 1) / batchSize, 0);
+	JobSystem::GetInstance()->ParallelFor(count, batchSize, [&body, &sums, iBegin, batchSize](int begin, int end) {
+		sums[begin / batchSize] = body.sumLoop(iBegin + begin, iBegin + end);
+	});
+
+	btScalar sum = 0;
+	for (btScalar batchSum : sums) {
+		sum += batchSum;
+	}
+	return sum;
+}
+
+btDiscreteDynamicsWorld* PhysicsTaskScheduler::CreateWorld(bool multithreaded) {
+	btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
+	btBroadphaseInterface* broadphase = new btDbvtBroadphase();
+
+	if (!multithreaded) {
+		btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
+		btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver();
+		return new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+	}
+
+	// Bullet sizes its per thread storage from the scheduler, so it is set first
+	if (btGetTaskScheduler() != GetInstance()) {
+		btSetTaskScheduler(GetInstance());
+	}
+
+	// Islands are solved in parallel, each by a solver of the pool
+	btCollisionDispatcherMt* dispatcher = new btCollisionDispatcherMt(collisionConfiguration);
+	btConstraintSolverPoolMt* solverPool = new btConstraintSolverPoolMt(GetInstance()->getMaxNumThreads());
+	btSequentialImpulseConstraintSolverMt* solver = new btSequentialImpulseConstraintSolverMt();
+	return new btDiscreteDynamicsWorldMt(dispatcher, broadphase, solverPool, solver, collisionConfiguration);
+}
@@ -0,0 +1,34 @@
+#ifndef H_PHYSICSTASKSCHEDULER
+#define H_PHYSICSTASKSCHEDULER
+#include "btBulletDynamicsCommon.h"
+#include "LinearMath/btThreads.h"
+
+// Runs Bullet's parallel loops on the JobSystem threads instead of a thread
+// pool of Bullet's own. Bullet keeps per thread storage for every thread that
+// may run its loops, so it is told about all JobSystem threads; setNumThreads
+// only caps how many batches a loop is split into, and so how many threads
+// work on it at once.
+class PhysicsTaskScheduler : public btITaskScheduler {
+public:
+	static PhysicsTaskScheduler* GetInstance();
+
+	PhysicsTaskScheduler(PhysicsTaskScheduler& physicsTaskScheduler) = delete;
+
+	int getMaxNumThreads() const override;
+	int getNumThreads() const override;
+	void setNumThreads(int numThreads) override;
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+
+	// A btDiscreteDynamicsWorld, or with multithreaded a btDiscreteDynamicsWorldMt
+	// with a pool of constraint solvers that steps on this scheduler
+	static btDiscreteDynamicsWorld* CreateWorld(bool multithreaded);
+private:
+	PhysicsTaskScheduler();
+	inline static PhysicsTaskScheduler* instance;
+
+	int activeThreadCount;
+
+	int GetBatchSize(int count, int grainSize) const;
+};
+#endif
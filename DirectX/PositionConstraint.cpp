@@ -2,20 +2,11 @@
 
 PositionConstraint::PositionConstraint(GameObject* gameObject)
 	:
-	Component(gameObject),
-	constrainer(0),
-	distance()
+	Component(gameObject)
 {}
 
-void PositionConstraint::Update() {
-	if (constrainer) {
-		btTransform newTransform = gameObject->GetTransform();
-		newTransform.setOrigin(constrainer->GetTransform().getOrigin() + distance);
-		gameObject->SetTransform(newTransform);
-	}
-}
+void PositionConstraint::Update() {}
 
 void PositionConstraint::SetConstrainer(GameObject* constrainer) {
-	distance = gameObject->GetTransform().getOrigin() - constrainer->GetTransform().getOrigin();
-	this->constrainer = constrainer;
+	gameObject->SetParent(constrainer, false);
 }
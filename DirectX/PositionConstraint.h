@@ -1,13 +1,16 @@
 #include "Component.h"
 #include "GameObject.h"
 
+// Keeps the object at a fixed offset from its constrainer. This is a position
+// only parent in the transform hierarchy, the offset is kept as the local position.
 class PositionConstraint : public Component {
 public:
 	PositionConstraint(GameObject* gameObject);
 
+	static const ComponentType TYPE = COMPONENT_TYPE_POSITION_CONSTRAINT;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+	static const int UPDATE_ORDER = UPDATE_ORDER_CONSTRAINT;
+
 	void Update() override;
 	void SetConstrainer(GameObject* constrainer);
-private:
-	GameObject* constrainer;
-	btVector3 distance;
 };
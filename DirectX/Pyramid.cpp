@@ -3,38 +3,76 @@
 #include "IndexBuffer.h"
 #include "Clock.h"
 #include "Game.h"
+#include "ShaderResources.h"
 #include "TransformConstantBuffer.h"
 #include "ColorConstantBuffer.h"
 
 Pyramid::Pyramid(GameObject* gameObject)
 	:
-	ShapeBase<Pyramid>(gameObject, 4, 12)
+	ShapeBase<Pyramid>(gameObject, 12, 12)
 {
-	VERTEX vertices[] = {
-		{ 0.0f, 0.0f, -1.0f },
-		{ 0.0f, 1.0f, 0.0f },
-		{ 0.5f, -0.5f, 0.0f},
-		{ -0.5f, -0.5f, 0.0f }
-	};
-
-	unsigned short indices[] = {
-		0, 1, 2,	// Right face
-		0, 2, 3,	// Bottom face
-		0, 3, 1,	// Left face
-		1, 3, 2		// Floor
-	};
+	SetupVertices();
+	SetupIndices();
 
 	if (bindables.size() == 0) {
 		VertexBuffer* vb = new VertexBuffer(vertexCount);
-		bindables.push_back(vb);
-
 		TransformConstantBuffer* tcb = new TransformConstantBuffer();
-		bindables.push_back(tcb);
-
 		ColorConstantBuffer* ccb = new ColorConstantBuffer(4);
+		IndexBuffer* ib = new IndexBuffer(indices, indexCount);
+		ShaderResources* sr = new ShaderResources(256, 256);
+
+		// ORDER OF LOADING MATTERS
+		bindables.push_back(sr);	// THIS MUST BE LOADED FIRST
+		bindables.push_back(vb);
+		bindables.push_back(tcb);
 		bindables.push_back(ccb);
 
-		IndexBuffer* ib = new IndexBuffer(indices, indexCount);
 		this->indexBuffer = ib;
 	}
 }
+
+void Pyramid::SetupVertices() {
+	btVector3 corners[] = {
+		btVector3(0.0f, 0.0f, -1.0f),
+		btVector3(0.0f, 1.0f, 0.0f),
+		btVector3(0.5f, -0.5f, 0.0f),
+		btVector3(-0.5f, -0.5f, 0.0f)
+	};
+
+	int faces[4][3] = {
+		{ 0, 1, 2 },	// Right face
+		{ 0, 2, 3 },	// Bottom face
+		{ 0, 3, 1 },	// Left face
+		{ 1, 3, 2 }		// Floor
+	};
+
+	float texCoords[3][2] = { { 0.0f, 1.0f }, { 0.5f, 0.0f }, { 1.0f, 1.0f } };
+	btVector3 center = (corners[0] + corners[1] + corners[2] + corners[3]) / 4;
+
+	// Every face gets its own vertices so that the normals stay flat
+	for (int face = 0; face < 4; face++) {
+		btVector3 a = corners[faces[face][0]];
+		btVector3 b = corners[faces[face][1]];
+		btVector3 c = corners[faces[face][2]];
+
+		btVector3 normal = (b - a).cross(c - a).normalized();
+		if (normal.dot((a + b + c) / 3 - center) < 0) {
+			normal = -normal;
+		}
+
+		for (int corner = 0; corner < 3; corner++) {
+			btVector3 position = corners[faces[face][corner]];
+			vertices[face * 3 + corner] = {
+				{ (float)position.x(), (float)position.y(), (float)position.z() },
+				{ (float)normal.x(), (float)normal.y(), (float)normal.z() },
+				{ texCoords[corner][0], texCoords[corner][1] }
+			};
+		}
+	}
+}
+
+void Pyramid::SetupIndices() {
+	for (int i = 0; i < indexCount; i++) {
+		indices[i] = i;
+	}
+}
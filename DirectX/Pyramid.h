@@ -4,5 +4,11 @@
 
 class Pyramid : public ShapeBase<Pyramid> {
 public:
+	static const ComponentType TYPE = COMPONENT_TYPE_PYRAMID;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE) | Shape::MASK;
+
 	Pyramid(GameObject* gameObject);
+protected:
+	void SetupVertices() override;
+	void SetupIndices() override;
 };
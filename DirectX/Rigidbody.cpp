@@ -3,20 +3,39 @@
 #include "Component.h"
 #include "GameObject.h"
 #include "Physics.h"
+#include "CollisionShapeCache.h"
+#include "Shape.h"
+#include "Cube.h"
 
 Rigidbody::Rigidbody(GameObject* gameObject)
 	:
 	Component(gameObject),
-	isKinematic(false)
+	isKinematic(false),
+	colliderPending(false),
+	motionState(this, gameObject->GetTransform())
 {
-	btScalar mass = 0;
-	btCollisionShape* shape = new btBoxShape(gameObject->GetScale());
-	btVector3 localInertia(0, 0, 0);
-	shape->calculateLocalInertia(mass, localInertia);
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(gameObject->GetTransform());
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, shape, localInertia);
+	// Static until given a mass, with a box until Physics picks the collider
+	btRigidBody::btRigidBodyConstructionInfo rbInfo(0, &motionState, CollisionShapeCache::GetInstance()->AcquireBox(gameObject->GetScale()), btVector3(0, 0, 0));
 	rigidbody = new btRigidBody(rbInfo);
+	rigidbody->setUserPointer(this);
 	Physics::GetInstance()->AddRigidbody(rigidbody);
+
+	if (!HasBoxCollider()) {
+		colliderPending = true;
+		Physics::GetInstance()->AddPendingCollider(this);
+	}
+}
+
+Rigidbody::~Rigidbody() {
+	Physics::GetInstance()->RemoveRigidbody(rigidbody);
+	if (motionState.queued) {
+		Physics::GetInstance()->ForgetMoved(this);
+	}
+	if (colliderPending) {
+		Physics::GetInstance()->ForgetPendingCollider(this);
+	}
+	CollisionShapeCache::GetInstance()->Release(rigidbody->getCollisionShape());
+	delete rigidbody;
 }
 
 btVector3 Rigidbody::GetLinearVelocity() {
@@ -25,21 +44,67 @@ btVector3 Rigidbody::GetLinearVelocity() {
 
 void Rigidbody::SetIsKinematic(bool isKinematic) {
 	this->isKinematic = isKinematic;
+	bool wasStatic = rigidbody->isStaticObject();
 
 	if (isKinematic) {
-		rigidbody->setCollisionFlags(rigidbody->getCollisionFlags() |
-			btCollisionObject::CF_KINEMATIC_OBJECT);
-		rigidbody->setActivationState(DISABLE_DEACTIVATION);
-
 		// Correction if necessary
-		SetMass(0);
+		rigidbody->setMassProps(0, btVector3(0, 0, 0));
+		rigidbody->setActivationState(DISABLE_DEACTIVATION);
 	}
+	else if (rigidbody->isKinematicObject()) {
+		rigidbody->forceActivationState(ACTIVE_TAG);
+	}
+	UpdateBodyType(wasStatic);
 }
 
 void Rigidbody::Update() {
-	btTransform transform;
-	rigidbody->getMotionState()->getWorldTransform(transform);
+	// Never called, the pool is not updated, see UPDATES
+}
+
+bool Rigidbody::SyncTransform(int step, btScalar interpolation) {
+	// Not moved by the last step, it rests where that step left it
+	if (motionState.movedStep < step) {
+		motionState.previous = motionState.current;
+		motionState.queued = false;
+		gameObject->SetTransform(motionState.current);
+		return false;
+	}
+
+	// Kinematic bodies are moved by the game and drawn where they were put,
+	// the others between the last two steps so motion is smooth at any frame rate
+	if (isKinematic) {
+		gameObject->SetTransform(motionState.current);
+		return true;
+	}
+	btTransform transform(
+		motionState.previous.getRotation().slerp(motionState.current.getRotation(), interpolation),
+		motionState.previous.getOrigin().lerp(motionState.current.getOrigin(), interpolation)
+	);
 	gameObject->SetTransform(transform);
+	return true;
+}
+
+Rigidbody::MotionState::MotionState(Rigidbody* owner, btTransform transform)
+	:
+	owner(owner),
+	current(transform),
+	previous(transform),
+	movedStep(-1),
+	queued(false)
+{}
+
+void Rigidbody::MotionState::getWorldTransform(btTransform& worldTransform) const {
+	worldTransform = current;
+}
+
+void Rigidbody::MotionState::setWorldTransform(const btTransform& worldTransform) {
+	previous = current;
+	current = worldTransform;
+	movedStep = Physics::GetInstance()->GetStepCount();
+	if (!queued) {
+		queued = true;
+		Physics::GetInstance()->MarkMoved(owner);
+	}
 }
 
 void Rigidbody::SetMass(btScalar mass) {
@@ -47,14 +112,89 @@ void Rigidbody::SetMass(btScalar mass) {
 		Main::HandleError(0, __FILE__, __LINE__, "Tried to set mass on Kinematic Object");
 	}
 
-	Physics::GetInstance()->RemoveRigidbody(rigidbody);
-	btCollisionShape* shape = new btBoxShape(gameObject->GetScale());
+	// Applied to the body in place, the inertia follows in UpdateBodyType
+	bool wasStatic = rigidbody->isStaticObject();
+	rigidbody->setMassProps(mass, btVector3(0, 0, 0));
+	UpdateBodyType(wasStatic);
+}
+
+void Rigidbody::ResolveCollider() {
+	colliderPending = false;
+	UpdateBodyType(rigidbody->isStaticObject());
+}
+
+void Rigidbody::UpdateBodyType(bool wasStatic) {
+	btScalar mass = rigidbody->getInvMass() > 0 ? 1 / rigidbody->getInvMass() : 0;
+	bool isDynamic = !isKinematic && mass > 0;
+
+	// Acquired before the old one is released, so an unchanged shape stays
+	// alive. A pending body keeps its box until ResolveCollider.
+	btCollisionShape* shape = rigidbody->getCollisionShape();
+	btCollisionShape* collider = shape;
+	if (!colliderPending) {
+		collider = AcquireCollider(isDynamic);
+		CollisionShapeCache::GetInstance()->Release(shape);
+	}
+	bool shapeChanged = collider != shape;
+	if (shapeChanged) {
+		rigidbody->setCollisionShape(collider);
+	}
+
 	btVector3 localInertia(0, 0, 0);
-	shape->calculateLocalInertia(mass, localInertia);
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(gameObject->GetTransform());
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, shape, localInertia);
-	rigidbody = new btRigidBody(rbInfo);
-	Physics::GetInstance()->AddRigidbody(rigidbody);
+	if (isDynamic) {
+		collider->calculateLocalInertia(mass, localInertia);
+	}
+	rigidbody->setMassProps(isDynamic ? mass : 0, localInertia);
+	rigidbody->updateInertiaTensor();
+
+	// setMassProps marks every massless body static, kinematic ones must not be
+	int flags = rigidbody->getCollisionFlags() & ~(btCollisionObject::CF_STATIC_OBJECT | btCollisionObject::CF_KINEMATIC_OBJECT);
+	if (isKinematic) {
+		flags |= btCollisionObject::CF_KINEMATIC_OBJECT;
+	}
+	else if (rigidbody->getInvMass() == 0) {
+		flags |= btCollisionObject::CF_STATIC_OBJECT;
+	}
+	rigidbody->setCollisionFlags(flags);
+
+	// The world only steps bodies that were not static when added, crossing
+	// over or a new shape needs the body added again. Otherwise the broadphase
+	// filter is updated in place, the same way addRigidBody picks it.
+	if (rigidbody->isStaticObject() != wasStatic || shapeChanged) {
+		Physics::GetInstance()->RemoveRigidbody(rigidbody);
+		Physics::GetInstance()->AddRigidbody(rigidbody);
+
+		// The world puts a body added as static to sleep, and nothing else
+		// would ever wake it
+		if (isDynamic) {
+			rigidbody->forceActivationState(ACTIVE_TAG);
+			rigidbody->activate(true);
+		}
+	}
+	else if (btBroadphaseProxy* proxy = rigidbody->getBroadphaseProxy()) {
+		proxy->m_collisionFilterGroup = isDynamic ? btBroadphaseProxy::DefaultFilter : btBroadphaseProxy::StaticFilter;
+		proxy->m_collisionFilterMask = isDynamic ? btBroadphaseProxy::AllFilter : btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter;
+	}
+}
+
+bool Rigidbody::HasBoxCollider() {
+	// A cube is its box already, the cheapest shape there is
+	return !gameObject->GetComponent<Shape>() || gameObject->GetComponent<Cube>();
+}
+
+btCollisionShape* Rigidbody::AcquireCollider(bool isDynamic) {
+	CollisionShapeCache* cache = CollisionShapeCache::GetInstance();
+	Shape* shape = gameObject->GetComponent<Shape>();
+
+	if (HasBoxCollider()) {
+		return cache->AcquireBox(gameObject->GetScale());
+	}
+
+	// Hulls for moving bodies, the exact triangles for the ones that only move when told to
+	if (isDynamic) {
+		return cache->AcquireConvexHull(shape->GetVertices(), shape->GetVertexCount(), gameObject->GetScale());
+	}
+	return cache->AcquireTriangleMesh(shape->GetVertices(), shape->GetVertexCount(), shape->GetIndices(), shape->GetIndexCount(), gameObject->GetScale());
 }
 
 void Rigidbody::ApplyImpulse(btVector3 force) {
@@ -6,6 +6,13 @@ class GameObject;
 class Rigidbody : public Component {
 public:
 	Rigidbody(GameObject* gameObject);
+	~Rigidbody();
+
+	static const ComponentType TYPE = COMPONENT_TYPE_RIGIDBODY;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+	static const int UPDATE_ORDER = UPDATE_ORDER_RIGIDBODY;
+	// Physics syncs the bodies it moved, the others cost nothing a frame
+	static const bool UPDATES = false;
 
 	btVector3 GetLinearVelocity();
 
@@ -17,7 +24,40 @@ public:
 	void SetGravity(btVector3 gravity);
 	void SetFriction(btScalar friction);
 	void SetAngularFactor(btVector3 factor);
+
+	// Physics, for bodies Bullet moved. Writes the transform drawn this frame,
+	// between the last two steps, and returns false once the body stopped.
+	bool SyncTransform(int step, btScalar interpolation);
+
+	// Physics, before the first step the body takes part in. Bodies start with
+	// a box and get their real collider once their type is settled, so no
+	// triangle tree is built for a body that is made dynamic right away.
+	void ResolveCollider();
 private:
+	// Bullet reads the body's transform from here and reports every move of an
+	// active body back while stepping, static and sleeping bodies are never reported
+	class MotionState : public btMotionState {
+	public:
+		MotionState(Rigidbody* owner, btTransform transform);
+
+		void getWorldTransform(btTransform& worldTransform) const override;
+		void setWorldTransform(const btTransform& worldTransform) override;
+
+		Rigidbody* owner;
+		btTransform current;
+		btTransform previous;
+		int movedStep;
+		bool queued;			// In the moved list of Physics
+	};
+
 	btRigidBody* rigidbody;
 	bool isKinematic;
+	bool colliderPending;
+	MotionState motionState;
+
+	// Static, kinematic or dynamic from the mass and isKinematic, wasStatic
+	// is what the world knew the body as. Picks the collider and inertia to match.
+	void UpdateBodyType(bool wasStatic);
+	bool HasBoxCollider();
+	btCollisionShape* AcquireCollider(bool isDynamic);
 };
@@ -0,0 +1,152 @@
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <cstring>
+#include "SceneCooker.h"
+#include "SceneFormat.h"
+#include "Main.h"
+#include "btBulletDynamicsCommon.h"
+
+namespace {
+	void ParseError(std::string textPath, int line, std::string description) {
+		Main::HandleError(0, __FILE__, __LINE__, textPath + "(" + std::to_string(line) + "): " + description);
+	}
+
+	void ReadFloats(std::istringstream& in, float* values, int count, std::string textPath, int line) {
+		for (int i = 0; i < count; i++) {
+			if (!(in >> values[i])) {
+				ParseError(textPath, line, "Expected " + std::to_string(count) + " numbers");
+			}
+		}
+	}
+}
+
+void SceneCooker::Cook(std::string textPath, std::string binaryPath) {
+	std::ifstream text(textPath);
+	if (!text) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not open " + textPath);
+	}
+
+	std::vector<SceneObject> objects;
+	std::string strings;
+	std::map<std::string, uint32_t> stringOffsets;
+
+	SceneObject object;
+	bool inObject = false;
+	std::string lineText;
+	for (int line = 1; std::getline(text, lineText); line++) {
+		std::istringstream in(lineText.substr(0, lineText.find('#')));
+		std::string keyword;
+		if (!(in >> keyword)) {
+			continue;
+		}
+
+		if (keyword == "object") {
+			if (inObject) {
+				ParseError(textPath, line, "Missing end before object");
+			}
+
+			memset(&object, 0, sizeof(object));
+			object.rotation[3] = 1;
+			object.scale[0] = object.scale[1] = object.scale[2] = 1;
+			object.texture = SCENE_NO_STRING;
+			inObject = true;
+			continue;
+		}
+		if (!inObject) {
+			ParseError(textPath, line, "Expected object");
+		}
+
+		if (keyword == "end") {
+			objects.push_back(object);
+			inObject = false;
+		}
+		else if (keyword == "position") {
+			ReadFloats(in, object.position, 3, textPath, line);
+		}
+		else if (keyword == "rotation") {
+			float degrees[3];
+			ReadFloats(in, degrees, 3, textPath, line);
+			btQuaternion rotation(btRadians(degrees[0]), btRadians(degrees[1]), btRadians(degrees[2]));
+			object.rotation[0] = rotation.x();
+			object.rotation[1] = rotation.y();
+			object.rotation[2] = rotation.z();
+			object.rotation[3] = rotation.w();
+		}
+		else if (keyword == "scale") {
+			ReadFloats(in, object.scale, 3, textPath, line);
+		}
+		else if (keyword == "shape") {
+			std::string shape;
+			in >> shape;
+			if (shape == "cube") {
+				object.shape = SCENE_SHAPE_CUBE;
+			}
+			else if (shape == "wedge") {
+				object.shape = SCENE_SHAPE_WEDGE;
+			}
+			else if (shape == "pyramid") {
+				object.shape = SCENE_SHAPE_PYRAMID;
+			}
+			else {
+				ParseError(textPath, line, "Unknown shape " + shape);
+			}
+		}
+		else if (keyword == "texture") {
+			std::string path;
+			if (!(in >> path)) {
+				ParseError(textPath, line, "Expected a texture path");
+			}
+
+			// Every path is stored once, objects share the offset
+			auto it = stringOffsets.find(path);
+			if (it == stringOffsets.end()) {
+				it = stringOffsets.insert({ path, (uint32_t)strings.size() }).first;
+				strings.append(path);
+				strings.push_back('\0');
+			}
+			object.texture = it->second;
+		}
+		else if (keyword == "rigidbody") {
+			ReadFloats(in, &object.mass, 1, textPath, line);
+			object.flags |= SCENE_OBJECT_RIGIDBODY;
+
+			std::string kinematic;
+			if (in >> kinematic && kinematic == "kinematic") {
+				object.flags |= SCENE_OBJECT_KINEMATIC;
+			}
+		}
+		else if (keyword == "light") {
+			ReadFloats(in, &object.lightIntensity, 1, textPath, line);
+			object.flags |= SCENE_OBJECT_LIGHT;
+		}
+		else if (keyword == "faceColors") {
+			ReadFloats(in, &object.faceColors[0][0], 24, textPath, line);
+			object.flags |= SCENE_OBJECT_FACE_COLORS;
+		}
+		else {
+			ParseError(textPath, line, "Unknown keyword " + keyword);
+		}
+	}
+
+	if (inObject) {
+		Main::HandleError(0, __FILE__, __LINE__, textPath + ": Missing end after the last object");
+	}
+
+	SceneFileHeader header;
+	memcpy(header.magic, SCENE_MAGIC, sizeof(header.magic));
+	header.version = SCENE_VERSION;
+	header.objectCount = objects.size();
+	header.objectsOffset = sizeof(SceneFileHeader);
+	header.stringsOffset = header.objectsOffset + objects.size() * sizeof(SceneObject);
+	header.stringsSize = strings.size();
+
+	std::ofstream binary(binaryPath, std::ios::binary | std::ios::trunc);
+	if (!binary) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not open " + binaryPath + " for writing");
+	}
+	binary.write((const char*)&header, sizeof(header));
+	binary.write((const char*)objects.data(), objects.size() * sizeof(SceneObject));
+	binary.write(strings.data(), strings.size());
+}
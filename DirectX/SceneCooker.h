@@ -0,0 +1,22 @@
+#ifndef H_SCENECOOKER
+#define H_SCENECOOKER
+#include <string>
+
+// Turns a text scene into the binary format of SceneFormat.h. The text format
+// is one object per block:
+//   object
+//   position 0 -2 0
+//   rotation 0 0 0			yaw, pitch and roll in degrees
+//   scale 10 1 10
+//   shape cube				cube, wedge or pyramid
+//   texture grass.jpg
+//   rigidbody 0 kinematic	mass, then optionally kinematic
+//   light 1
+//   faceColors r g b a ...	six colors, one per face
+//   end
+// Everything but object and end is optional, # starts a comment.
+class SceneCooker {
+public:
+	static void Cook(std::string textPath, std::string binaryPath);
+};
+#endif
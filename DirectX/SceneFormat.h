@@ -0,0 +1,52 @@
+#ifndef H_SCENEFORMAT
+#define H_SCENEFORMAT
+#include <cstdint>
+
+// Binary scene layout, little endian, written by SceneCooker and memory mapped
+// by SceneLoader:
+//   SceneFileHeader
+//   SceneObject[objectCount]			at objectsOffset
+//   nul terminated strings				at stringsOffset, referenced by offset
+// Bump SCENE_VERSION on any change to these structs.
+#define SCENE_MAGIC "DXSC"
+#define SCENE_VERSION 1
+#define SCENE_NO_STRING 0xFFFFFFFFu
+
+struct SceneFileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t objectCount;
+	uint32_t objectsOffset;
+	uint32_t stringsOffset;
+	uint32_t stringsSize;
+};
+
+enum SceneShape : uint32_t {
+	SCENE_SHAPE_NONE,
+	SCENE_SHAPE_CUBE,
+	SCENE_SHAPE_WEDGE,
+	SCENE_SHAPE_PYRAMID,
+};
+
+enum SceneObjectFlags : uint32_t {
+	SCENE_OBJECT_RIGIDBODY = 1 << 0,
+	SCENE_OBJECT_KINEMATIC = 1 << 1,
+	SCENE_OBJECT_LIGHT = 1 << 2,
+	SCENE_OBJECT_FACE_COLORS = 1 << 3,
+};
+
+struct SceneObject {
+	float position[3];
+	float rotation[4];			// Quaternion x, y, z, w
+	float scale[3];
+	uint32_t shape;				// SceneShape
+	uint32_t flags;				// SceneObjectFlags
+	uint32_t texture;			// String offset or SCENE_NO_STRING
+	float mass;
+	float lightIntensity;
+	float faceColors[6][4];
+};
+
+static_assert(sizeof(SceneFileHeader) == 24, "SceneFileHeader must not have padding");
+static_assert(sizeof(SceneObject) == 156, "SceneObject must not have padding");
+#endif
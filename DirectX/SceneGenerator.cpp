@@ -0,0 +1,188 @@
+#include <cmath>
+#include "SceneGenerator.h"
+#include "GameObject.h"
+#include "Graphics.h"
+#include "Cube.h"
+#include "Wedge.h"
+#include "Pyramid.h"
+#include "Rigidbody.h"
+#include "Light.h"
+#include "Texture.h"
+
+namespace {
+	FaceColor palette[][6] = {
+		{
+			{ 1.0f, 0.0f, 0.0f, 1.0f },
+			{ 0.0f, 1.0f, 0.0f, 1.0f },
+			{ 0.0f, 0.0f, 1.0f, 1.0f },
+			{ 1.0f, 0.0f, 0.0f, 1.0f },
+			{ 1.0f, 0.0f, 1.0f, 1.0f },
+			{ 1.0f, 1.0f, 0.0f, 1.0f },
+		},
+		{
+			{ 0.2f, 0.2f, 0.2f, 1.0f },
+			{ 0.4f, 0.4f, 0.4f, 1.0f },
+			{ 0.2f, 0.2f, 0.2f, 1.0f },
+			{ 0.4f, 0.4f, 0.4f, 1.0f },
+			{ 0.2f, 0.2f, 0.2f, 1.0f },
+			{ 0.4f, 0.4f, 0.4f, 1.0f },
+		},
+	};
+	const int paletteCount = sizeof(palette) / sizeof(palette[0]);
+}
+
+SceneGenerator::SceneGenerator(Config config)
+	:
+	config(config),
+	state(0)
+{
+	// PCG32 seeding, see https://www.pcg-random.org
+	NextUInt();
+	state += config.seed;
+	NextUInt();
+}
+
+uint32_t SceneGenerator::NextUInt() {
+	// Hand rolled instead of <random> because the standard distributions are
+	// not guaranteed to produce the same values across standard libraries
+	uint64_t oldState = state;
+	state = oldState * 6364136223846793005ULL + 1442695040888963407ULL;
+	uint32_t xorShifted = (uint32_t)(((oldState >> 18u) ^ oldState) >> 27u);
+	uint32_t rotation = (uint32_t)(oldState >> 59u);
+	return (xorShifted >> rotation) | (xorShifted << ((-(int32_t)rotation) & 31));
+}
+
+float SceneGenerator::NextFloat() {
+	// 24 random bits map exactly onto the float mantissa
+	return (NextUInt() >> 8) * (1.0f / 16777216.0f);
+}
+
+float SceneGenerator::NextFloat(float min, float max) {
+	return min + (max - min) * NextFloat();
+}
+
+std::vector<GameObject*> SceneGenerator::Generate() {
+	std::vector<GameObject*> gameObjects;
+	gameObjects.reserve(config.objectCount);
+
+	for (int i = 0; i < config.objectCount; i++) {
+		gameObjects.push_back(SpawnObject(i));
+	}
+
+	SpawnLights();
+
+	return gameObjects;
+}
+
+btTransform SceneGenerator::GetSpawnTransform(int index, btVector3 scale) {
+	btTransform transform;
+	transform.setIdentity();
+
+	// Every branch draws the same amount of numbers so layouts don't shift the sequence
+	float jitterX = NextFloat(-0.25f, 0.25f) * config.spacing;
+	float jitterY = NextFloat(0.0f, 0.5f) * config.spacing;
+	float jitterZ = NextFloat(-0.25f, 0.25f) * config.spacing;
+	float yaw = NextFloat(0.0f, SIMD_2_PI);
+	float pitch = NextFloat(0.0f, SIMD_2_PI);
+	float roll = NextFloat(0.0f, SIMD_2_PI);
+
+	if (config.layout == Layout::Grid) {
+		int columns = (int)std::ceil(std::sqrt((float)config.objectCount));
+		int row = index / columns;
+		int column = index % columns;
+
+		transform.setOrigin(config.origin + btVector3(
+			(column - columns / 2) * config.spacing,
+			scale.y(),
+			(row - columns / 2) * config.spacing
+		));
+	}
+	else {
+		int side = (int)std::ceil(std::cbrt((float)config.objectCount));
+		int layer = index / (side * side);
+		int row = (index / side) % side;
+		int column = index % side;
+
+		transform.setOrigin(config.origin + btVector3(
+			(column - side / 2) * config.spacing + jitterX,
+			layer * config.spacing + jitterY + scale.y(),
+			(row - side / 2) * config.spacing + jitterZ
+		));
+		transform.setRotation(btQuaternion(yaw, pitch, roll));
+	}
+
+	return transform;
+}
+
+GameObject* SceneGenerator::SpawnObject(int index) {
+	btVector3 scale(
+		NextFloat(config.minScale, config.maxScale),
+		NextFloat(config.minScale, config.maxScale),
+		NextFloat(config.minScale, config.maxScale)
+	);
+	float shapeRoll = NextFloat(0.0f, config.cubeWeight + config.wedgeWeight + config.pyramidWeight);
+	float bodyRoll = NextFloat();
+	float textureRoll = NextFloat();
+	uint32_t textureIndex = NextUInt();
+	uint32_t paletteIndex = NextUInt();
+
+	GameObject* object = new GameObject(GetSpawnTransform(index, scale), scale);
+
+	if (shapeRoll < config.cubeWeight) {
+		object->AddComponent<Cube>();
+	}
+	else if (shapeRoll < config.cubeWeight + config.wedgeWeight) {
+		object->AddComponent<Wedge>();
+	}
+	else {
+		object->AddComponent<Pyramid>();
+	}
+
+	Shape* shape = object->GetComponent<Shape>();
+	shape->SetFaceColors(palette[paletteIndex % paletteCount]);
+
+	// Shapes own their Textures, the file itself is loaded once by the TextureCache
+	if (config.texturePaths.size() > 0 && textureRoll < config.texturedFraction) {
+		textureIndex %= config.texturePaths.size();
+		shape->SetTexture(new Texture(config.texturePaths[textureIndex]));
+	}
+
+	if (bodyRoll < config.dynamicFraction) {
+		object->AddComponent<Rigidbody>();
+		Rigidbody* rb = object->GetComponent<Rigidbody>();
+		rb->SetMass(scale.x() * scale.y() * scale.z());
+		rb->SetIsKinematic(false);
+	}
+	else if (bodyRoll < config.dynamicFraction + config.staticFraction) {
+		object->AddComponent<Rigidbody>();
+		Rigidbody* rb = object->GetComponent<Rigidbody>();
+		rb->SetMass(0);
+		rb->SetIsKinematic(true);
+	}
+
+	return object;
+}
+
+void SceneGenerator::SpawnLights() {
+	// The lighting buffer has a fixed size, so only fill what is left of it
+	int lightCount = config.lightCount;
+	int freeLightCount = MAX_LIGHT_COUNT - Graphics::GetInstance()->GetLightCount();
+	if (lightCount > freeLightCount) {
+		lightCount = freeLightCount;
+	}
+
+	float extent = config.spacing * std::ceil(std::sqrt((float)config.objectCount)) / 2;
+	for (int i = 0; i < lightCount; i++) {
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(config.origin + btVector3(
+			NextFloat(-extent, extent),
+			NextFloat(2.0f, 6.0f),
+			NextFloat(-extent, extent)
+		));
+
+		GameObject* object = new GameObject(transform, btVector3(1, 1, 1));
+		object->AddComponent<Light>();
+		object->GetComponent<Light>()->lightData.SetDiffuseIntensity(NextFloat(0.1f, 1.0f));
+	}
+}
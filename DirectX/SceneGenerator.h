@@ -0,0 +1,59 @@
+#ifndef H_SCENEGENERATOR
+#define H_SCENEGENERATOR
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "btBulletDynamicsCommon.h"
+
+class GameObject;
+
+// Spawns large, reproducible scenes for scaling tests. The same config and seed
+// always produce the same objects in the same order, on every machine.
+class SceneGenerator {
+public:
+	enum class Layout {
+		Grid,	// Evenly spaced objects on the XZ plane
+		Pile	// Objects scattered over a footprint and stacked upwards
+	};
+
+	struct Config {
+		uint32_t seed = 1;
+		int objectCount = 1000;
+		Layout layout = Layout::Grid;
+		btVector3 origin = btVector3(0, 0, 0);
+		float spacing = 3.0f;
+		float minScale = 0.25f;
+		float maxScale = 1.0f;
+
+		// Relative weights of each shape type
+		float cubeWeight = 1.0f;
+		float wedgeWeight = 1.0f;
+		float pyramidWeight = 1.0f;
+
+		// Share of the objects that get a non-kinematic rigidbody with mass
+		float dynamicFraction = 0.5f;
+		// Share of the objects that get a static rigidbody
+		float staticFraction = 0.25f;
+
+		int lightCount = 4;
+
+		std::vector<std::string> texturePaths = { "brick.jpg", "grass.jpg", "dog.jpg" };
+		float texturedFraction = 0.75f;
+	};
+
+	SceneGenerator(Config config);
+
+	std::vector<GameObject*> Generate();
+private:
+	Config config;
+	uint64_t state;
+
+	uint32_t NextUInt();
+	float NextFloat();
+	float NextFloat(float min, float max);
+
+	btTransform GetSpawnTransform(int index, btVector3 scale);
+	GameObject* SpawnObject(int index);
+	void SpawnLights();
+};
+#endif
@@ -0,0 +1,146 @@
+#include <cstring>
+#include "SceneLoader.h"
+#include "SceneFormat.h"
+#include "Main.h"
+#include "Game.h"
+#include "ComponentPool.h"
+#include "GameObject.h"
+#include "Graphics.h"
+#include "TransformHierarchy.h"
+#include "Cube.h"
+#include "Wedge.h"
+#include "Pyramid.h"
+#include "Rigidbody.h"
+#include "Light.h"
+#include "Texture.h"
+
+SceneLoader* SceneLoader::GetInstance() {
+	if (!instance) {
+		instance = new SceneLoader();
+	}
+	return instance;
+}
+
+SceneLoader::SceneLoader() {}
+
+std::vector<GameObject*> SceneLoader::Load(std::string path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		Main::HandleError(HRESULT_FROM_WIN32(GetLastError()), __FILE__, __LINE__, "Could not open scene " + path);
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = fileSize.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	const unsigned char* data = mapping ? (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!data) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		Main::HandleError(HRESULT_FROM_WIN32(GetLastError()), __FILE__, __LINE__, "Could not map scene " + path);
+	}
+
+	size_t size = (size_t)fileSize.QuadPart;
+	const SceneFileHeader* header = (const SceneFileHeader*)data;
+	bool valid = size >= sizeof(SceneFileHeader)
+		&& memcmp(header->magic, SCENE_MAGIC, sizeof(header->magic)) == 0
+		&& header->version == SCENE_VERSION
+		&& header->objectsOffset + (uint64_t)header->objectCount * sizeof(SceneObject) <= size
+		&& header->stringsOffset + (uint64_t)header->stringsSize <= size
+		&& (header->stringsSize == 0 || data[header->stringsOffset + header->stringsSize - 1] == '\0');
+	if (!valid) {
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		CloseHandle(file);
+		Main::HandleError(0, __FILE__, __LINE__, path + " is not a scene of version " + std::to_string(SCENE_VERSION));
+	}
+
+	const SceneObject* objects = (const SceneObject*)(data + header->objectsOffset);
+	const char* strings = (const char*)(data + header->stringsOffset);
+	int objectCount = header->objectCount;
+
+	// Size everything once instead of growing while constructing
+	int counts[4] = {};
+	int rigidbodyCount = 0;
+	int lightCount = 0;
+	int coloredCount = 0;
+	for (int i = 0; i < objectCount; i++) {
+		if (objects[i].shape < 4) {
+			counts[objects[i].shape]++;
+		}
+		rigidbodyCount += (objects[i].flags & SCENE_OBJECT_RIGIDBODY) != 0;
+		lightCount += (objects[i].flags & SCENE_OBJECT_LIGHT) != 0;
+		coloredCount += (objects[i].flags & SCENE_OBJECT_FACE_COLORS) != 0;
+	}
+
+	Game::GetInstance()->Reserve(objectCount);
+	TransformHierarchy::GetInstance()->Reserve(objectCount);
+	ComponentPool<Cube>::GetInstance()->Reserve(counts[SCENE_SHAPE_CUBE]);
+	ComponentPool<Wedge>::GetInstance()->Reserve(counts[SCENE_SHAPE_WEDGE]);
+	ComponentPool<Pyramid>::GetInstance()->Reserve(counts[SCENE_SHAPE_PYRAMID]);
+	ComponentPool<Rigidbody>::GetInstance()->Reserve(rigidbodyCount);
+	ComponentPool<Light>::GetInstance()->Reserve(lightCount);
+
+	FaceColor* faceColors = nullptr;
+	if (coloredCount > 0) {
+		faceColors = new FaceColor[coloredCount * 6];
+		faceColorBlocks.push_back(faceColors);
+	}
+
+	std::vector<GameObject*> gameObjects;
+	gameObjects.reserve(objectCount);
+
+	for (int i = 0; i < objectCount; i++) {
+		const SceneObject& source = objects[i];
+
+		btTransform transform(
+			btQuaternion(source.rotation[0], source.rotation[1], source.rotation[2], source.rotation[3]),
+			btVector3(source.position[0], source.position[1], source.position[2])
+		);
+		btVector3 scale(source.scale[0], source.scale[1], source.scale[2]);
+		GameObject* object = new GameObject(transform, scale);
+		gameObjects.push_back(object);
+
+		switch (source.shape) {
+		case SCENE_SHAPE_CUBE:
+			object->AddComponent<Cube>();
+			break;
+		case SCENE_SHAPE_WEDGE:
+			object->AddComponent<Wedge>();
+			break;
+		case SCENE_SHAPE_PYRAMID:
+			object->AddComponent<Pyramid>();
+			break;
+		}
+
+		Shape* shape = object->GetComponent<Shape>();
+		if (shape && source.texture != SCENE_NO_STRING && source.texture < header->stringsSize) {
+			shape->SetTexture(new Texture(strings + source.texture));
+		}
+		if (shape && (source.flags & SCENE_OBJECT_FACE_COLORS)) {
+			memcpy(faceColors, source.faceColors, sizeof(source.faceColors));
+			shape->SetFaceColors(faceColors);
+			faceColors += 6;
+		}
+
+		if (source.flags & SCENE_OBJECT_RIGIDBODY) {
+			object->AddComponent<Rigidbody>();
+			Rigidbody* rb = object->GetComponent<Rigidbody>();
+			bool kinematic = (source.flags & SCENE_OBJECT_KINEMATIC) != 0;
+			rb->SetIsKinematic(kinematic);
+			rb->SetMass(kinematic ? 0 : source.mass);
+		}
+
+		if (source.flags & SCENE_OBJECT_LIGHT) {
+			object->AddComponent<Light>();
+			object->GetComponent<Light>()->lightData.SetDiffuseIntensity(source.lightIntensity);
+		}
+	}
+
+	UnmapViewOfFile(data);
+	CloseHandle(mapping);
+	CloseHandle(file);
+
+	return gameObjects;
+}
@@ -0,0 +1,24 @@
+#ifndef H_SCENELOADER
+#define H_SCENELOADER
+#include <string>
+#include <vector>
+
+class GameObject;
+struct FaceColor;
+
+// Loads scenes cooked by SceneCooker. The file is memory mapped and read in
+// place, every pool is sized for the whole scene before the first object is
+// made, and each texture file is loaded once however many objects use it.
+class SceneLoader {
+public:
+	static SceneLoader* GetInstance();
+
+	std::vector<GameObject*> Load(std::string path);
+private:
+	SceneLoader();
+	inline static SceneLoader* instance;
+
+	// Shapes keep a pointer to their colors, so they live as long as the loader
+	std::vector<FaceColor*> faceColorBlocks;
+};
+#endif
@@ -1,16 +1,39 @@
 #include <Windows.h>
 #include "Script.h"
+#include "ScriptScheduler.h"
 
 Script::Script(GameObject* gameObject)
 	:
 	Component(gameObject),
-	onUpdate([](GameObject* gameObject)->void {})
+	onUpdate(nullptr),
+	coroutine(nullptr),
+	taskId(-1)
 {}
 
+Script::~Script() {
+	Stop();
+}
+
 void Script::Update() {
-	onUpdate(gameObject);
+	// Coroutine scripts are resumed by the scheduler, not here
+	if (onUpdate) {
+		onUpdate(gameObject);
+	}
 }
 
 void Script::SetOnUpdate(function<void(GameObject* gameObject)> onUpdate) {
 	this->onUpdate = onUpdate;
 }
+
+void Script::Start(function<ScriptTask(GameObject* gameObject)> coroutine) {
+	Stop();
+	this->coroutine = coroutine;
+	taskId = ScriptScheduler::GetInstance()->Start(this->coroutine(gameObject));
+}
+
+void Script::Stop() {
+	if (taskId >= 0) {
+		ScriptScheduler::GetInstance()->Cancel(taskId);
+		taskId = -1;
+	}
+}
@@ -1,15 +1,29 @@
 #include <functional>
 #include "Component.h"
 #include "GameObject.h"
+#include "ScriptTask.h"
 
 using namespace std;
 
 class Script : public Component {
 public:
 	Script(GameObject* gameObject);
+	~Script();
+
+	static const ComponentType TYPE = COMPONENT_TYPE_SCRIPT;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+	static const int UPDATE_ORDER = UPDATE_ORDER_SCRIPT;
 
 	void Update() override;
 	void SetOnUpdate(function<void(GameObject* gameObject)> onUpdate);
+
+	// Runs a coroutine on the ScriptScheduler until it returns or the script is
+	// destroyed, replacing the one started before. The function is kept here so
+	// a lambda's captures outlive the coroutine.
+	void Start(function<ScriptTask(GameObject* gameObject)> coroutine);
+	void Stop();
 private:
 	function<void(GameObject* gameObject)> onUpdate;
+	function<ScriptTask(GameObject* gameObject)> coroutine;
+	int taskId;
 };
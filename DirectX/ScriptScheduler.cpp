@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include "ScriptScheduler.h"
+#include "Clock.h"
+#include "Keyboard.h"
+
+ScriptScheduler* ScriptScheduler::GetInstance() {
+	if (!instance) {
+		instance = new ScriptScheduler();
+		Register(instance);
+	}
+	return instance;
+}
+
+ScriptScheduler::ScriptScheduler()
+	:
+	nextTaskId(0),
+	resumingTask(-1),
+	resumingCancelled(false),
+	lastTick(GetTick(Clock::GetSingleton().GetTimeSinceStart()))
+{}
+
+int ScriptScheduler::GetUpdateOrder() {
+	return UPDATE_ORDER;
+}
+
+int ScriptScheduler::Start(ScriptTask task) {
+	int id = nextTaskId++;
+	ScriptTask::Handle handle = task.Release();
+	handle.promise().id = id;
+	liveTasks[id] = handle;
+
+	WakeNextFrame(id);
+	return id;
+}
+
+void ScriptScheduler::Cancel(int task) {
+	auto it = liveTasks.find(task);
+	if (it == liveTasks.end()) {
+		return;
+	}
+
+	// Resume destroys it after it suspends
+	if (task == resumingTask) {
+		resumingCancelled = true;
+		return;
+	}
+
+	// Waits that still point at the task are skipped when they come up
+	it->second.destroy();
+	liveTasks.erase(it);
+}
+
+bool ScriptScheduler::IsRunning(int task) {
+	return liveTasks.count(task) > 0 && !(task == resumingTask && resumingCancelled);
+}
+
+int ScriptScheduler::GetRunningCount() {
+	return liveTasks.size();
+}
+
+void ScriptScheduler::WakeNextFrame(int task) {
+	nextFrame.push_back(GetWake(task));
+}
+
+void ScriptScheduler::WakeAfter(int task, float seconds) {
+	float wakeTime = Clock::GetSingleton().GetTimeSinceStart() + seconds;
+	int64_t tick = (int64_t)std::ceil(wakeTime / TICK_SECONDS);
+	if (tick <= lastTick) {
+		WakeNextFrame(task);
+		return;
+	}
+
+	Wake wake = GetWake(task);
+	wheel[tick % WHEEL_SIZE].push_back({ wake.task, wake.generation, tick });
+}
+
+void ScriptScheduler::WakeOnKey(int task, WPARAM key) {
+	// Dropping the outdated waits here keeps a list from growing when its key
+	// is never pressed
+	std::vector<Wake>& waiters = keyWaiters[key];
+	std::erase_if(waiters, [this](Wake wake) {
+		return !IsCurrent(wake);
+	});
+	waiters.push_back(GetWake(task));
+}
+
+void ScriptScheduler::Update() {
+	ready.clear();
+	readyKeys.clear();
+
+	for (Wake wake : nextFrame) {
+		ready.push_back(wake);
+		readyKeys.push_back(0);
+	}
+	nextFrame.clear();
+
+	// Only the buckets of the ticks that passed since the last update are
+	// visited, a frame longer than a whole revolution visits each bucket once
+	int64_t tick = GetTick(Clock::GetSingleton().GetTimeSinceStart());
+	for (int64_t t = std::max(lastTick + 1, tick - WHEEL_SIZE + 1); t <= tick; t++) {
+		std::vector<Timer>& bucket = wheel[t % WHEEL_SIZE];
+		for (int i = 0; i < bucket.size();) {
+			// Timers of later revolutions share the bucket and stay
+			if (bucket[i].tick > tick) {
+				i++;
+				continue;
+			}
+
+			ready.push_back({ bucket[i].task, bucket[i].generation });
+			readyKeys.push_back(0);
+			bucket[i] = bucket.back();
+			bucket.pop_back();
+		}
+	}
+	lastTick = std::max(lastTick, tick);
+
+	for (auto& [key, waiters] : keyWaiters) {
+		if (waiters.size() == 0 || !Keyboard::GetInstance()->IsDown(key)) {
+			continue;
+		}
+
+		for (Wake wake : waiters) {
+			ready.push_back(wake);
+			readyKeys.push_back(key);
+		}
+		waiters.clear();
+	}
+
+	// A task waiting on several things can be in here more than once, the
+	// first resume makes the other entries outdated
+	for (int i = 0; i < ready.size(); i++) {
+		Resume(ready[i], readyKeys[i]);
+	}
+}
+
+ScriptScheduler::Wake ScriptScheduler::GetWake(int task) {
+	return { task, liveTasks[task].promise().generation };
+}
+
+bool ScriptScheduler::IsCurrent(Wake wake) {
+	auto it = liveTasks.find(wake.task);
+	return it != liveTasks.end() && it->second.promise().generation == wake.generation;
+}
+
+void ScriptScheduler::Resume(Wake wake, WPARAM key) {
+	if (!IsCurrent(wake)) {
+		return;
+	}
+
+	ScriptTask::Handle handle = liveTasks[wake.task];
+	handle.promise().generation++;
+	handle.promise().wokenByKey = key;
+	resumingTask = wake.task;
+	resumingCancelled = false;
+	handle.resume();
+	resumingTask = -1;
+
+	if (handle.done() || resumingCancelled) {
+		handle.destroy();
+		liveTasks.erase(wake.task);
+	}
+}
+
+int64_t ScriptScheduler::GetTick(float time) {
+	return (int64_t)std::floor(time / TICK_SECONDS);
+}
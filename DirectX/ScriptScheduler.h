@@ -0,0 +1,71 @@
+#ifndef H_SCRIPTSCHEDULER
+#define H_SCRIPTSCHEDULER
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "System.h"
+#include "ScriptTask.h"
+
+// Owns every running coroutine script and resumes it when what it awaits is
+// ready. Timed waits sit in a timer wheel, so only the buckets whose time has
+// come get looked at, and key waits are grouped by key.
+class ScriptScheduler : public System {
+public:
+	static ScriptScheduler* GetInstance();
+
+	static const int UPDATE_ORDER = UPDATE_ORDER_SCRIPT;
+
+	// The task first runs on the next update, returns an id for Cancel
+	int Start(ScriptTask task);
+	// Destroys the coroutine, safe to call with the id of a finished task. A
+	// task cancelling itself is destroyed once it suspends.
+	void Cancel(int task);
+	bool IsRunning(int task);
+	int GetRunningCount();
+
+	void WakeNextFrame(int task);
+	void WakeAfter(int task, float seconds);
+	void WakeOnKey(int task, WPARAM key);
+
+	void Update() override;
+	int GetUpdateOrder() override;
+private:
+	ScriptScheduler();
+	inline static ScriptScheduler* instance;
+
+	static const int WHEEL_SIZE = 256;
+	static constexpr float TICK_SECONDS = 1.0f / 100.0f;
+
+	struct Wake {
+		int task;
+		uint32_t generation;
+	};
+
+	struct Timer {
+		int task;
+		uint32_t generation;
+		int64_t tick;
+	};
+
+	std::unordered_map<int, ScriptTask::Handle> liveTasks;
+	int nextTaskId;
+
+	// The task being resumed, its frame cannot be destroyed until it suspends
+	int resumingTask;
+	bool resumingCancelled;
+
+	std::vector<Wake> nextFrame;
+	std::vector<Timer> wheel[WHEEL_SIZE];
+	int64_t lastTick;
+	std::unordered_map<WPARAM, std::vector<Wake>> keyWaiters;
+
+	// Filled before anything is resumed, resumed tasks add new waits freely
+	std::vector<Wake> ready;
+	std::vector<WPARAM> readyKeys;
+
+	Wake GetWake(int task);
+	bool IsCurrent(Wake wake);
+	void Resume(Wake wake, WPARAM key);
+	int64_t GetTick(float time);
+};
+#endif
@@ -0,0 +1,48 @@
+#include "ScriptTask.h"
+#include "ScriptScheduler.h"
+
+ScriptTask::ScriptTask(Handle handle)
+	:
+	handle(handle)
+{}
+
+ScriptTask::ScriptTask(ScriptTask&& task) noexcept
+	:
+	handle(task.Release())
+{}
+
+ScriptTask::~ScriptTask() {
+	if (handle) {
+		handle.destroy();
+	}
+}
+
+ScriptTask::Handle ScriptTask::Release() {
+	Handle released = handle;
+	handle = nullptr;
+	return released;
+}
+
+void NextFrame::await_suspend(ScriptTask::Handle handle) {
+	ScriptScheduler::GetInstance()->WakeNextFrame(handle.promise().id);
+}
+
+WaitSeconds::WaitSeconds(float seconds)
+	:
+	seconds(seconds)
+{}
+
+void WaitSeconds::await_suspend(ScriptTask::Handle handle) {
+	ScriptScheduler::GetInstance()->WakeAfter(handle.promise().id, seconds);
+}
+
+void WaitForKey::await_suspend(ScriptTask::Handle handle) {
+	this->handle = handle;
+	for (WPARAM key : keys) {
+		ScriptScheduler::GetInstance()->WakeOnKey(handle.promise().id, key);
+	}
+}
+
+WPARAM WaitForKey::await_resume() {
+	return handle.promise().wokenByKey;
+}
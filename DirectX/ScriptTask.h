@@ -0,0 +1,75 @@
+#ifndef H_SCRIPTTASK
+#define H_SCRIPTTASK
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include <Windows.h>
+
+// Return type of coroutine scripts. The coroutine does not run until it is
+// handed to the ScriptScheduler, which then resumes it whenever whatever it
+// awaits is ready. A suspended script costs nothing per frame.
+class ScriptTask {
+public:
+	struct promise_type {
+		int id = -1;
+		// Bumped on every resume, wake ups from older waits are ignored
+		uint32_t generation = 0;
+		WPARAM wokenByKey = 0;
+
+		ScriptTask get_return_object() {
+			return ScriptTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { throw; }
+	};
+
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	ScriptTask(ScriptTask&& task) noexcept;
+	ScriptTask(ScriptTask& task) = delete;
+	~ScriptTask();
+
+	// Gives up ownership of the coroutine, used by the scheduler
+	Handle Release();
+private:
+	ScriptTask(Handle handle);
+
+	Handle handle;
+};
+
+// co_await NextFrame() resumes on the next frame
+struct NextFrame {
+	bool await_ready() { return false; }
+	void await_suspend(ScriptTask::Handle handle);
+	void await_resume() {}
+};
+
+// co_await WaitSeconds(t) resumes on the first frame at least t seconds later
+struct WaitSeconds {
+	float seconds;
+
+	WaitSeconds(float seconds);
+	bool await_ready() { return seconds <= 0; }
+	void await_suspend(ScriptTask::Handle handle);
+	void await_resume() {}
+};
+
+// co_await WaitForKey('W') resumes on the first frame the key is down and
+// returns it, with several keys any one of them will do
+struct WaitForKey {
+	std::vector<WPARAM> keys;
+	ScriptTask::Handle handle;
+
+	template<typename... Keys>
+	WaitForKey(WPARAM key, Keys... others)
+		:
+		keys({ key, (WPARAM)others... })
+	{}
+	bool await_ready() { return false; }
+	void await_suspend(ScriptTask::Handle handle);
+	WPARAM await_resume();
+};
+#endif
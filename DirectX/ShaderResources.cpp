@@ -2,8 +2,6 @@
 #include "ShaderResources.h"
 #include "Texture.h"
 #include "Graphics.h"
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include "stb_image_resize.h"
 
 ShaderResources::ShaderResources(int width, int height)
     :
@@ -13,7 +11,7 @@ ShaderResources::ShaderResources(int width, int height)
     width(width),
     height(height)
 {
-    // Create the texture
+    // Blank texture for shapes without one, so they show only their face colors
     D3D11_TEXTURE2D_DESC textureDesc;
     ZeroMemory(&textureDesc, sizeof(textureDesc));
     textureDesc.Width = width;
@@ -25,7 +23,6 @@ ShaderResources::ShaderResources(int width, int height)
     textureDesc.SampleDesc.Quality = 0u;
     textureDesc.Usage = D3D11_USAGE_DEFAULT;
     textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
     GFX_THROW_INFO(Graphics::GetInstance()->GetDevice()->CreateTexture2D(
         &textureDesc,
@@ -33,15 +30,6 @@ ShaderResources::ShaderResources(int width, int height)
         &imageTexture
     ));
 
-    textureDesc.Usage = D3D11_USAGE_STAGING;
-    textureDesc.BindFlags = 0u;
-    textureDesc.ArraySize = 6u;
-    GFX_THROW_INFO(Graphics::GetInstance()->GetDevice()->CreateTexture2D(
-        &textureDesc,
-        NULL,
-        &imageTextureCopy
-    ));
-
     // Create the resource view
     GFX_THROW_INFO(Graphics::GetInstance()->GetDevice()->CreateShaderResourceView(imageTexture,
         nullptr,
@@ -70,54 +58,16 @@ ShaderResources::ShaderResources(int width, int height)
 
 void ShaderResources::Bind(Shape* shape) {
     Texture* texture = shape->GetTexture();
+    ID3D11ShaderResourceView* textureView = texture ? texture->GetShaderResourceView() : nullptr;
 
-    if (texture && texture->image->data) {
-        if (texture->image->width != width || texture->image->height != height) {
-            unsigned char* resizedImageData = (unsigned char*)malloc(width * height * texture->image->channelCount);
-            stbir_resize_uint8(
-                texture->image->data,
-                texture->image->width,
-                texture->image->height,
-                0,
-                resizedImageData,
-                width,
-                height,
-                0,
-                texture->image->channelCount
-            );
-
-            free(texture->image->data);
-
-            // Modify the image struct
-            texture->image->data = resizedImageData;
-            texture->image->width = width;
-            texture->image->height = height;
-        }
-
-        int imageRowPitch = texture->image->width * texture->image->channelCount;
-
-        // Modify the texture copy
-        for (int i = 0; i < 1; i++) {
-            D3D11_MAPPED_SUBRESOURCE msr = {};
-            Graphics::GetInstance()->GetDeviceContext()->Map(imageTextureCopy, i, D3D11_MAP_WRITE, 0u, &msr);
-            BYTE* mappedData = reinterpret_cast<BYTE*>(msr.pData);
-            BYTE* newTextureData = texture->image->data;
-            for (UINT row = 0; row < texture->image->height; row++)
-            {
-                memcpy(mappedData, newTextureData, imageRowPitch);
-                mappedData += msr.RowPitch;
-                newTextureData += imageRowPitch;
-            }
-            Graphics::GetInstance()->GetDeviceContext()->Unmap(imageTextureCopy, i);
-        }
-
-        // Move the texture copy to the texture
-        Graphics::GetInstance()->GetDeviceContext()->CopyResource(imageTexture, imageTextureCopy);
-
+    if (textureView) {
         // Set the shader
         currentShader = SHADER_FILE_NAME_TEXTURE;
     }
+    else {
+        textureView = shaderResourceView;
+    }
 
-    Graphics::GetInstance()->GetDeviceContext()->PSSetShaderResources(0, 1, &shaderResourceView);
+    Graphics::GetInstance()->GetDeviceContext()->PSSetShaderResources(0, 1, &textureView);
     Graphics::GetInstance()->GetDeviceContext()->PSSetSamplers(0, 1, &samplerState);
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "Shape.h"
 #include "Graphics.h"
 #include "btBulletDynamicsCommon.h"
@@ -6,6 +7,8 @@
 #include "Texture.h"
 #include "Window.h"
 #include "Game.h"
+#include "MeshArena.h"
+#include "Camera.h"
 
 Shape::Shape(GameObject* gameObject, int vertexCount, int indexCount)
 	:
@@ -16,13 +19,19 @@ Shape::Shape(GameObject* gameObject, int vertexCount, int indexCount)
     vertexCount(vertexCount),
     indexCount(indexCount)
 {
-    vertices = (VERTEX*)malloc(vertexCount * sizeof(VERTEX));
-    indices = (unsigned short*)malloc(indexCount * sizeof(unsigned short));
+    // Vertices and indices share one block, VERTEX keeps the indices aligned
+    unsigned char* geometry = (unsigned char*)MeshArena::GetInstance()->Allocate(GetGeometrySize());
+    vertices = (VERTEX*)geometry;
+    indices = (unsigned short*)(geometry + vertexCount * sizeof(VERTEX));
 }
 
 Shape::~Shape() {
-    free(vertices);
-    free(indices);
+    delete texture;
+    MeshArena::GetInstance()->Free(vertices, GetGeometrySize());
+}
+
+size_t Shape::GetGeometrySize() {
+    return vertexCount * sizeof(VERTEX) + indexCount * sizeof(unsigned short);
 }
 
 btTransform Shape::GetTransform() {
@@ -33,6 +42,11 @@ btVector3 Shape::GetScale() {
     return gameObject->GetScale();
 }
 
+bool Shape::IsVisible() {
+    // Culled against the frustum of whichever pass is being drawn
+    return gameObject->IsVisible(Graphics::GetInstance()->IsRenderingShadowMap());
+}
+
 Texture* Shape::GetTexture() {
     return texture;
 }
@@ -53,10 +67,29 @@ unsigned short* Shape::GetIndices() {
     return indices;
 }
 
+int Shape::GetIndexCount() {
+    return indexCount;
+}
+
 void Shape::SetTexture(Texture* texture) {
+    if (this->texture != texture) {
+        delete this->texture;
+    }
     this->texture = texture;
 }
 
 void Shape::SetFaceColors(FaceColor* pFaceColors) {
     this->faceColors = pFaceColors;
 }
+
+void Shape::RequestTextureDetail() {
+    Camera* camera = Game::GetInstance()->GetMainCamera();
+    if (!texture || !camera || Graphics::GetInstance()->IsRenderingShadowMap()) {
+        return;
+    }
+
+    // Every face is mapped with the whole texture, the largest one decides
+    const dx::BoundingBox& bounds = gameObject->GetWorldBounds();
+    float size = 2.0f * std::max(std::max(bounds.Extents.x, bounds.Extents.y), bounds.Extents.z);
+    texture->RequestScreenSize(size * camera->GetPixelsPerUnit(bounds));
+}
@@ -16,6 +16,9 @@ struct VERTEX;
 
 class Shape : public Component {
 public:
+	static const ComponentType TYPE = COMPONENT_TYPE_SHAPE;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE);
+
 	btTransform GetTransform();
 	btVector3 GetScale();
 	Texture* GetTexture();
@@ -23,9 +26,16 @@ public:
 	VERTEX* GetVertices();
 	int GetVertexCount();
 	unsigned short* GetIndices();
+	int GetIndexCount();
+	bool IsVisible();
 
+	// The shape owns its Texture and deletes it with itself or the next one set.
+	// Textures of the same path share one TextureCache entry.
 	void SetTexture(Texture* texture);
 	void SetFaceColors(FaceColor* pFaceColors);
+
+	// Tells the texture how large this shape is on screen, so it streams the mips it needs
+	void RequestTextureDetail();
 protected:
 	Shape(GameObject* gameObject, int vertexCount, int indexCount);
 	~Shape();
@@ -38,6 +48,8 @@ protected:
 	unsigned short* indices;
 	int indexCount;
 
+	size_t GetGeometrySize();
+
 	virtual void SetupVertices() = 0;
 	virtual void SetupIndices() = 0;
 };
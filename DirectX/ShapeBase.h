@@ -8,7 +8,14 @@
 template<class T>
 class ShapeBase : public Shape {
 public:
+	static const int UPDATE_ORDER = UPDATE_ORDER_SHAPE;
+
 	void Update() override {
+        if (!IsVisible()) {
+            return;
+        }
+        RequestTextureDetail();
+
         for (Bindable* bindable : bindables) {
             bindable->Bind(this);
         }
@@ -0,0 +1,65 @@
+#ifndef H_SLABALLOCATOR
+#define H_SLABALLOCATOR
+#include <vector>
+#include "AllocatorStats.h"
+
+// Fixed size allocator for one type. Memory comes from the heap in slabs of
+// SLAB_SIZE elements and freed elements are chained into an intrusive free list,
+// so steady state allocation never touches the global heap.
+template<class T, int SLAB_SIZE = 256>
+class SlabAllocator {
+public:
+	SlabAllocator(const char* name)
+		:
+		stats(name),
+		freeList(nullptr),
+		slabUsed(SLAB_SIZE)
+	{}
+
+	void* Allocate() {
+		stats.allocationCount++;
+		stats.liveBytes += sizeof(Element);
+
+		if (freeList) {
+			Element* element = freeList;
+			freeList = element->next;
+			return element;
+		}
+
+		if (slabUsed == SLAB_SIZE) {
+			slabs.push_back(new Element[SLAB_SIZE]);
+			slabUsed = 0;
+			stats.heapAllocationCount++;
+			stats.reservedBytes += SLAB_SIZE * sizeof(Element);
+		}
+		return &slabs.back()[slabUsed++];
+	}
+
+	void Free(void* pointer) {
+		if (!pointer) {
+			return;
+		}
+
+		stats.freeCount++;
+		stats.liveBytes -= sizeof(Element);
+
+		Element* element = static_cast<Element*>(pointer);
+		element->next = freeList;
+		freeList = element;
+	}
+
+	AllocatorStats* GetStats() {
+		return &stats;
+	}
+private:
+	union Element {
+		Element* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	AllocatorStats stats;
+	std::vector<Element*> slabs;
+	Element* freeList;
+	int slabUsed;
+};
+#endif
@@ -0,0 +1,67 @@
+#ifndef H_SPSCQUEUE
+#define H_SPSCQUEUE
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Head and tail only ever grow and are masked into the ring, so the
+// capacity must be a power of two. Plain standard C++, no platform headers.
+template<class T, size_t CAPACITY>
+class SpscQueue {
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+public:
+	SpscQueue()
+		:
+		head(0),
+		tail(0)
+	{}
+
+	SpscQueue(SpscQueue& queue) = delete;
+
+	// Producer only, false when the queue is full
+	bool TryPush(const T& item) {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - cachedHead == CAPACITY) {
+			cachedHead = head.load(std::memory_order_acquire);
+			if (currentTail - cachedHead == CAPACITY) {
+				return false;
+			}
+		}
+
+		items[currentTail & (CAPACITY - 1)] = item;
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, false when the queue is empty
+	bool TryPop(T* item) {
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == cachedTail) {
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (currentHead == cachedTail) {
+				return false;
+			}
+		}
+
+		*item = items[currentHead & (CAPACITY - 1)];
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Exact only when called from one of the two threads while the other is idle
+	size_t GetSize() {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	static constexpr size_t GetCapacity() {
+		return CAPACITY;
+	}
+private:
+	// Each side gets its own cache line so they don't invalidate each other
+	alignas(64) std::atomic<size_t> head;
+	size_t cachedTail = 0;		// Consumer's last look at tail
+	alignas(64) std::atomic<size_t> tail;
+	size_t cachedHead = 0;		// Producer's last look at head
+	alignas(64) T items[CAPACITY];
+};
+#endif
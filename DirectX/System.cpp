@@ -0,0 +1,20 @@
+#include "System.h"
+#include "Game.h"
+
+System::System() {}
+
+void System::Register(System* system) {
+	Game::GetInstance()->AddSystem(system);
+}
+
+AccessMask System::GetReads() {
+	return ACCESS_ALL;
+}
+
+AccessMask System::GetWrites() {
+	return ACCESS_ALL;
+}
+
+bool System::IsMainThreadOnly() {
+	return true;
+}
@@ -0,0 +1,50 @@
+#ifndef H_SYSTEM
+#define H_SYSTEM
+#include <cstdint>
+
+// Systems run once per frame in ascending update order. Everything at or
+// above UPDATE_ORDER_RENDER issues draw calls and runs inside the render passes.
+enum UpdateOrder {
+	UPDATE_ORDER_INPUT = 50,
+	UPDATE_ORDER_RIGIDBODY = 100,
+	UPDATE_ORDER_SCRIPT = 200,
+	UPDATE_ORDER_CONSTRAINT = 300,
+	UPDATE_ORDER_TRANSFORM = 350,
+	UPDATE_ORDER_LIGHT = 400,
+	UPDATE_ORDER_CAMERA = 500,
+	UPDATE_ORDER_RENDER = 1000,
+	UPDATE_ORDER_SHAPE = UPDATE_ORDER_RENDER,
+};
+
+// What a system reads and writes. The low 16 bits are component masks, see
+// COMPONENT_MASK, the rest is shared state that is not a component.
+typedef uint32_t AccessMask;
+
+enum Access : AccessMask {
+	ACCESS_TRANSFORM = 1u << 16,
+	ACCESS_PHYSICS = 1u << 17,
+	ACCESS_LIGHTING = 1u << 18,
+	ACCESS_VISIBILITY = 1u << 19,
+	ACCESS_RENDER = 1u << 20,
+	ACCESS_INPUT = 1u << 21,
+	ACCESS_ALL = 0xFFFFFFFFu,
+};
+
+// Game runs systems whose access does not conflict at the same time on the job
+// system. The defaults are the safe ones: a system that declares nothing reads
+// and writes everything and stays on the main thread.
+class System {
+public:
+	System(System& system) = delete;
+
+	virtual void Update() = 0;
+	virtual int GetUpdateOrder() = 0;
+	virtual AccessMask GetReads();
+	virtual AccessMask GetWrites();
+	virtual bool IsMainThreadOnly();
+protected:
+	System();
+
+	static void Register(System* system);
+};
+#endif
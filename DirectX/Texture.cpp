@@ -1,28 +1,44 @@
 #include "Texture.h"
+#include "TextureCache.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "SlabAllocator.h"
+
+static SlabAllocator<Texture>& GetAllocator() {
+    static SlabAllocator<Texture> allocator("Texture");
+    return allocator;
+}
+
+void* Texture::operator new(size_t size) {
+    return GetAllocator().Allocate();
+}
+
+void Texture::operator delete(void* pointer) {
+    GetAllocator().Free(pointer);
+}
 
 Texture::Texture(string texturePath)
 	:
-	image(0),
+	entry(TextureCache::GetInstance()->Acquire(texturePath)),
     texturePath(texturePath)
-{
-    if (textureCache.contains(texturePath)) {
-        image = textureCache[texturePath];
-    }
-    else {
-        // Load the image
-        int loadedWidth, loadedHeight;
-        int channelCount = 4;
-        unsigned char* imageData = stbi_load(texturePath.c_str(), &loadedWidth, &loadedHeight, NULL, channelCount);
-
-        image = new Image();
-        image->data = imageData;
-        image->width = loadedWidth;
-        image->height = loadedHeight;
-        image->channelCount = channelCount;
-
-        // Save to cache
-        textureCache[texturePath] = image;
-    }
+{}
+
+Texture::~Texture() {
+    TextureCache::GetInstance()->Release(entry);
+}
+
+Texture::Image* Texture::GetImage() {
+    return entry->image.loaded ? &entry->image : TextureCache::GetInstance()->GetPlaceholderImage();
+}
+
+bool Texture::IsLoaded() {
+    return entry->image.loaded;
+}
+
+ID3D11ShaderResourceView* Texture::GetShaderResourceView() {
+    return TextureCache::GetInstance()->GetShaderResourceView(entry);
+}
+
+void Texture::RequestScreenSize(float pixels) {
+    TextureCache::GetInstance()->RequestDetail(entry, pixels);
 }
@@ -1,21 +1,52 @@
-#include <map>
+#ifndef H_TEXTURE
+#define H_TEXTURE
 #include <string>
+#include "AllocatorStats.h"
+
+struct ID3D11ShaderResourceView;
+struct TextureEntry;
 
 using namespace std;
 
 class Texture {
 public:
+	// Returns right away, the file is decoded by the TextureLoader
 	Texture(string texturePath);
+	~Texture();
+
+	static void* operator new(size_t size);
+	static void operator delete(void* pointer);
 
+	// Decoded RGBA pixels, or the mip chain of a cooked DDS as stored in the
+	// file. Cooked textures start with their mip tail and have finer mips
+	// streamed in and dropped again as the camera moves.
 	struct Image {
 		unsigned char* data;
 		int width;
 		int height;
 		int channelCount;
-	}* image;
+		bool loaded;
+		unsigned int format;		// DDS_FORMAT_*
+		int mipCount;
+		size_t size;				// Bytes of data, all mips included
+		int firstMip;				// Finest mip in data
+		bool streamable;			// The file has the mips finer than firstMip
+	};
 
-private:
-	inline static map<std::string, Image*> textureCache;
+	// The shared placeholder until the file has been decoded. The pixels may
+	// be dropped once they are on the GPU, data is then nullptr.
+	Image* GetImage();
+	bool IsLoaded();
 
+	// nullptr if the file could not be decoded
+	ID3D11ShaderResourceView* GetShaderResourceView();
+
+	// Screen pixels across a surface drawn with the whole texture, called by
+	// everything using it. The largest this frame decides which mips stay resident.
+	void RequestScreenSize(float pixels);
+
+private:
+	TextureEntry* entry;
 	string texturePath;
 };
+#endif
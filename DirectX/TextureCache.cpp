@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "TextureCache.h"
+#include "TextureLoader.h"
+#include "Graphics.h"
+#include "DdsFormat.h"
+
+TextureCache* TextureCache::GetInstance() {
+	if (!instance) {
+		instance = new TextureCache();
+	}
+	return instance;
+}
+
+TextureCache::TextureCache()
+	:
+	hr(0),
+	cpuBudget(256 * 1024 * 1024),
+	gpuBudget(512 * 1024 * 1024),
+	residentCpuBytes(0),
+	residentGpuBytes(0),
+	residencyChangesLeft(MAX_RESIDENCY_CHANGES),
+	placeholderTexture(nullptr),
+	placeholderView(nullptr)
+{
+	// Flat grey, so textured objects read as such while they load
+	placeholderImage.width = 1;
+	placeholderImage.height = 1;
+	placeholderImage.channelCount = 4;
+	placeholderImage.data = (unsigned char*)malloc(placeholderImage.channelCount);
+	memset(placeholderImage.data, 128, placeholderImage.channelCount);
+	placeholderImage.loaded = true;
+	placeholderImage.format = DDS_FORMAT_R8G8B8A8_UNORM;
+	placeholderImage.mipCount = 1;
+	placeholderImage.size = placeholderImage.channelCount;
+	placeholderImage.firstMip = 0;
+	placeholderImage.streamable = false;
+}
+
+TextureEntry* TextureCache::Acquire(std::string path) {
+	auto found = entries.find(path);
+	if (found != entries.end()) {
+		TextureEntry* entry = found->second;
+		if (entry->released) {
+			released.erase(entry->releasedPosition);
+			entry->released = false;
+		}
+		entry->refCount++;
+		return entry;
+	}
+
+	TextureEntry* entry = new TextureEntry();
+	entry->path = path;
+	entry->image.data = nullptr;
+	entry->image.width = 0;
+	entry->image.height = 0;
+	entry->image.channelCount = 4;
+	entry->image.loaded = false;
+	entry->image.format = DDS_FORMAT_R8G8B8A8_UNORM;
+	entry->image.mipCount = 1;
+	entry->image.size = 0;
+	entry->image.firstMip = 0;
+	entry->image.streamable = false;
+	entry->streaming = false;
+	entry->requestedSize = 0;
+	entry->wantedMip = 0;
+	entry->gpuTexture = nullptr;
+	entry->shaderResourceView = nullptr;
+	entry->gpuBytes = 0;
+	entry->refCount = 1;
+	entry->released = false;
+	entries[path] = entry;
+
+	loading.push_back(entry);
+	TextureLoader::GetInstance()->Request(&entry->image, path, TextureLoader::MIP_TAIL);
+
+	return entry;
+}
+
+void TextureCache::Release(TextureEntry* entry) {
+	entry->refCount--;
+	if (entry->refCount == 0) {
+		entry->released = true;
+		entry->releasedPosition = released.insert(released.end(), entry);
+		Trim();
+	}
+}
+
+void TextureCache::Update() {
+	TextureLoader::GetInstance()->ProcessCompleted();
+	residencyChangesLeft = MAX_RESIDENCY_CHANGES;
+
+	// Count the pixels of every load that just finished
+	for (int i = 0; i < loading.size(); i++) {
+		TextureEntry* entry = loading[i];
+		if (entry->image.loaded) {
+			if (entry->image.data) {
+				residentCpuBytes += entry->image.size;
+			}
+			loading[i] = loading.back();
+			loading.pop_back();
+			i--;
+		}
+	}
+
+	UpdateStreaming();
+	Trim();
+}
+
+void TextureCache::RequestDetail(TextureEntry* entry, float size) {
+	entry->requestedSize = std::max(entry->requestedSize, size);
+}
+
+int TextureCache::GetWantedMip(TextureEntry* entry) {
+	Texture::Image* image = &entry->image;
+	int coarsest = GetDdsCoarsestFirstMip(image->format, image->width, image->height, image->mipCount);
+	if (entry->requestedSize < 1.0f) {
+		return coarsest;
+	}
+
+	// One texel per pixel across the surface
+	float texels = (float)std::max(image->width, image->height);
+	int mip = (int)floorf(log2f(texels / entry->requestedSize));
+	return std::min(std::max(mip, 0), coarsest);
+}
+
+size_t TextureCache::GetMipChainSize(Texture::Image* image, int firstMip) {
+	size_t size = 0;
+	for (int i = firstMip; i < image->mipCount; i++) {
+		size += GetDdsMipSize(image->format, std::max(image->width >> i, 1), std::max(image->height >> i, 1));
+	}
+	return size;
+}
+
+void TextureCache::UpdateStreaming() {
+	for (auto it = entries.begin(); it != entries.end(); it++) {
+		TextureEntry* entry = it->second;
+		if (!entry->image.loaded || !entry->image.streamable) {
+			continue;
+		}
+		entry->wantedMip = GetWantedMip(entry);
+		entry->requestedSize = 0;
+
+		if (entry->streaming) {
+			if (entry->streamed.loaded && residencyChangesLeft > 0) {
+				FinishStream(entry);
+				residencyChangesLeft--;
+			}
+			continue;
+		}
+
+		if (entry->wantedMip >= entry->image.firstMip || residencyChangesLeft == 0) {
+			continue;
+		}
+
+		// Only what fits, Trim would drop it again right away
+		size_t size = GetMipChainSize(&entry->image, entry->wantedMip);
+		size_t growth = size - GetMipChainSize(&entry->image, entry->image.firstMip);
+		if (residentCpuBytes + size > cpuBudget || residentGpuBytes + growth > gpuBudget) {
+			continue;
+		}
+
+		// The whole chain from the wanted mip down is read again, the coarse
+		// mips are small next to the finer ones
+		entry->streamed = entry->image;
+		entry->streamed.data = nullptr;
+		entry->streamed.loaded = false;
+		entry->streaming = true;
+		TextureLoader::GetInstance()->Request(&entry->streamed, entry->path, entry->wantedMip);
+		residencyChangesLeft--;
+	}
+}
+
+void TextureCache::FinishStream(TextureEntry* entry) {
+	entry->streaming = false;
+	if (!entry->streamed.data) {
+		// The cooked file went away, keep the mips there are
+		entry->image.streamable = false;
+		return;
+	}
+
+	// Uploaded again the next time it is bound
+	FreeCpuCopy(entry);
+	FreeGpuCopy(entry);
+	entry->image = entry->streamed;
+	residentCpuBytes += entry->image.size;
+}
+
+void TextureCache::DropFineMips(TextureEntry* entry, int firstMip) {
+	Texture::Image* image = &entry->image;
+	size_t size = GetMipChainSize(image, firstMip);
+
+	if (image->data) {
+		size_t dropped = image->size - size;
+		memmove(image->data, image->data + dropped, size);
+		image->data = (unsigned char*)realloc(image->data, size);
+		residentCpuBytes -= dropped;
+	}
+	image->size = size;
+
+	// The mips that stay are copied over on the GPU instead of being uploaded again
+	if (entry->shaderResourceView) {
+		ID3D11Texture2D* texture;
+		ID3D11ShaderResourceView* view;
+		Upload(image, firstMip, nullptr, &texture, &view);
+		for (int i = firstMip; i < image->mipCount; i++) {
+			Graphics::GetInstance()->GetDeviceContext()->CopySubresourceRegion(
+				texture, i - firstMip, 0u, 0u, 0u,
+				entry->gpuTexture, i - image->firstMip, nullptr
+			);
+		}
+
+		FreeGpuCopy(entry);
+		entry->gpuTexture = texture;
+		entry->shaderResourceView = view;
+		entry->gpuBytes = size;
+		residentGpuBytes += size;
+	}
+	image->firstMip = firstMip;
+}
+
+ID3D11ShaderResourceView* TextureCache::GetShaderResourceView(TextureEntry* entry) {
+	if (entry->shaderResourceView) {
+		return entry->shaderResourceView;
+	}
+
+	if (!entry->image.loaded) {
+		if (!placeholderView) {
+			Upload(&placeholderImage, 0, placeholderImage.data, &placeholderTexture, &placeholderView);
+		}
+		return placeholderView;
+	}
+
+	if (!entry->image.data) {
+		return nullptr;
+	}
+
+	Upload(&entry->image, entry->image.firstMip, entry->image.data, &entry->gpuTexture, &entry->shaderResourceView);
+	entry->gpuBytes = entry->image.size;
+	residentGpuBytes += entry->gpuBytes;
+	Trim();
+
+	return entry->shaderResourceView;
+}
+
+Texture::Image* TextureCache::GetPlaceholderImage() {
+	return &placeholderImage;
+}
+
+void TextureCache::Upload(Texture::Image* image, int firstMip, unsigned char* data, ID3D11Texture2D** texture, ID3D11ShaderResourceView** view) {
+	int mipCount = image->mipCount - firstMip;
+
+	D3D11_TEXTURE2D_DESC textureDesc;
+	ZeroMemory(&textureDesc, sizeof(textureDesc));
+	textureDesc.Width = std::max(image->width >> firstMip, 1);
+	textureDesc.Height = std::max(image->height >> firstMip, 1);
+	textureDesc.MipLevels = mipCount;
+	textureDesc.ArraySize = 1u;
+	textureDesc.Format = (DXGI_FORMAT)image->format;
+	textureDesc.SampleDesc.Count = 1u;
+	textureDesc.SampleDesc.Quality = 0u;
+	textureDesc.Usage = data ? D3D11_USAGE_IMMUTABLE : D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	// Mips follow each other in the data, largest first
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData(mipCount);
+	unsigned char* mipData = data;
+	for (int i = 0; data && i < mipCount; i++) {
+		int mipWidth = std::max(image->width >> (firstMip + i), 1);
+		int mipHeight = std::max(image->height >> (firstMip + i), 1);
+		initialData[i].pSysMem = mipData;
+		initialData[i].SysMemPitch = (UINT)GetDdsRowPitch(image->format, mipWidth);
+		mipData += GetDdsMipSize(image->format, mipWidth, mipHeight);
+	}
+
+	GFX_THROW_INFO(Graphics::GetInstance()->GetDevice()->CreateTexture2D(
+		&textureDesc,
+		data ? initialData.data() : nullptr,
+		texture
+	));
+
+	// The shaders sample a texture array
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+	viewDesc.Format = textureDesc.Format;
+	viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	viewDesc.Texture2DArray.MostDetailedMip = 0u;
+	viewDesc.Texture2DArray.MipLevels = mipCount;
+	viewDesc.Texture2DArray.FirstArraySlice = 0u;
+	viewDesc.Texture2DArray.ArraySize = 1u;
+
+	GFX_THROW_INFO(Graphics::GetInstance()->GetDevice()->CreateShaderResourceView(
+		*texture,
+		&viewDesc,
+		view
+	));
+}
+
+void TextureCache::FreeCpuCopy(TextureEntry* entry) {
+	if (!entry->image.data) {
+		return;
+	}
+
+	residentCpuBytes -= entry->image.size;
+	free(entry->image.data);
+	entry->image.data = nullptr;
+}
+
+void TextureCache::FreeGpuCopy(TextureEntry* entry) {
+	if (!entry->shaderResourceView) {
+		return;
+	}
+
+	residentGpuBytes -= entry->gpuBytes;
+	entry->shaderResourceView->Release();
+	entry->gpuTexture->Release();
+	entry->shaderResourceView = nullptr;
+	entry->gpuTexture = nullptr;
+	entry->gpuBytes = 0;
+}
+
+void TextureCache::Evict(TextureEntry* entry) {
+	FreeCpuCopy(entry);
+	FreeGpuCopy(entry);
+
+	released.erase(entry->releasedPosition);
+	entries.erase(entry->path);
+	delete entry;
+}
+
+void TextureCache::Trim() {
+	// Fine mips nothing on screen needs go first, they can be streamed back in
+	for (auto it = entries.begin(); (residentCpuBytes > cpuBudget || residentGpuBytes > gpuBudget) && residencyChangesLeft > 0 && it != entries.end(); it++) {
+		TextureEntry* entry = it->second;
+		if (!entry->released && entry->image.loaded && entry->image.streamable && !entry->streaming && entry->wantedMip > entry->image.firstMip) {
+			DropFineMips(entry, entry->wantedMip);
+			residencyChangesLeft--;
+		}
+	}
+
+	// Then unreferenced entries, oldest first. Entries still being loaded or
+	// streamed are skipped, the loader thread holds on to their image.
+	auto position = released.begin();
+	while ((residentCpuBytes > cpuBudget || residentGpuBytes > gpuBudget) && position != released.end()) {
+		TextureEntry* entry = *position;
+		position++;
+		if (entry->image.loaded && !entry->streaming) {
+			Evict(entry);
+		}
+	}
+
+	// Textures in use only need their pixels until they are on the GPU
+	for (auto it = entries.begin(); residentCpuBytes > cpuBudget && it != entries.end(); it++) {
+		if (it->second->shaderResourceView) {
+			FreeCpuCopy(it->second);
+		}
+	}
+}
+
+void TextureCache::SetBudget(size_t cpuBytes, size_t gpuBytes) {
+	cpuBudget = cpuBytes;
+	gpuBudget = gpuBytes;
+	Trim();
+}
+
+size_t TextureCache::GetCpuBudget() {
+	return cpuBudget;
+}
+
+size_t TextureCache::GetGpuBudget() {
+	return gpuBudget;
+}
+
+size_t TextureCache::GetResidentCpuBytes() {
+	return residentCpuBytes;
+}
+
+size_t TextureCache::GetResidentGpuBytes() {
+	return residentGpuBytes;
+}
+
+int TextureCache::GetEntryCount() {
+	return entries.size();
+}
+
+int TextureCache::GetReleasedCount() {
+	return released.size();
+}
+
+int TextureCache::GetStreamingCount() {
+	int count = 0;
+	for (auto it = entries.begin(); it != entries.end(); it++) {
+		if (it->second->streaming) {
+			count++;
+		}
+	}
+	return count;
+}
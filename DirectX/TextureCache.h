@@ -0,0 +1,98 @@
+#ifndef H_TEXTURECACHE
+#define H_TEXTURECACHE
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Main.h"
+#include "Texture.h"
+
+// One texture file, shared by every Texture made from its path
+struct TextureEntry {
+	std::string path;
+	Texture::Image image;
+	Texture::Image streamed;		// Finer mips on their way from the loader
+	bool streaming;
+	float requestedSize;			// Largest screen size asked for since the last Update
+	int wantedMip;
+	ID3D11Texture2D* gpuTexture;
+	ID3D11ShaderResourceView* shaderResourceView;
+	size_t gpuBytes;
+	int refCount;
+	bool released;
+	std::list<TextureEntry*>::iterator releasedPosition;
+};
+
+// Owns the decoded pixels and GPU copies of every texture file, shared by all
+// Textures made from the same path. Entries are refcounted by their Textures,
+// an entry nobody references stays resident for reuse until the CPU or GPU
+// budget is exceeded, then the least recently released ones are evicted.
+// Cooked textures load their mip tail first, finer mips are streamed in when
+// something drawn with them gets large enough on screen and are the first
+// thing dropped when over budget. Decoded files stay whole.
+class TextureCache {
+public:
+	static TextureCache* GetInstance();
+
+	TextureCache(TextureCache& textureCache) = delete;
+
+	TextureEntry* Acquire(std::string path);
+	void Release(TextureEntry* entry);
+
+	// Main thread, picks up finished loads, streams mips in or out and evicts down to the budget
+	void Update();
+
+	// Screen pixels across a surface drawn with the entry's whole texture
+	void RequestDetail(TextureEntry* entry, float size);
+
+	// Uploaded on first use, the placeholder's view while the file is loading
+	// and nullptr if it could not be decoded
+	ID3D11ShaderResourceView* GetShaderResourceView(TextureEntry* entry);
+	Texture::Image* GetPlaceholderImage();
+
+	void SetBudget(size_t cpuBytes, size_t gpuBytes);
+	size_t GetCpuBudget();
+	size_t GetGpuBudget();
+	size_t GetResidentCpuBytes();
+	size_t GetResidentGpuBytes();
+	int GetEntryCount();
+	int GetReleasedCount();
+	int GetStreamingCount();
+private:
+	TextureCache();
+	inline static TextureCache* instance;
+
+	// Streams started or finished and mips dropped per frame, so residency
+	// changes never stall a frame on uploads
+	static const int MAX_RESIDENCY_CHANGES = 4;
+
+	HRESULT hr;
+
+	std::unordered_map<std::string, TextureEntry*> entries;
+	std::vector<TextureEntry*> loading;
+	// Unreferenced entries, least recently released first
+	std::list<TextureEntry*> released;
+
+	size_t cpuBudget;
+	size_t gpuBudget;
+	size_t residentCpuBytes;
+	size_t residentGpuBytes;
+	int residencyChangesLeft;
+
+	Texture::Image placeholderImage;
+	ID3D11Texture2D* placeholderTexture;
+	ID3D11ShaderResourceView* placeholderView;
+
+	// Without data the texture is left empty for copies
+	void Upload(Texture::Image* image, int firstMip, unsigned char* data, ID3D11Texture2D** texture, ID3D11ShaderResourceView** view);
+	void FreeCpuCopy(TextureEntry* entry);
+	void FreeGpuCopy(TextureEntry* entry);
+	void Evict(TextureEntry* entry);
+	void UpdateStreaming();
+	void FinishStream(TextureEntry* entry);
+	void DropFineMips(TextureEntry* entry, int firstMip);
+	static int GetWantedMip(TextureEntry* entry);
+	static size_t GetMipChainSize(Texture::Image* image, int firstMip);
+	void Trim();
+};
+#endif
@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <emmintrin.h>
+#include "TextureCooker.h"
+#include "DdsFormat.h"
+#include "ImageProcessing.h"
+#include "JobSystem.h"
+#include "Main.h"
+#include "stb_image.h"
+
+namespace {
+	// Interpolation weights of 4 bit BC7 indices, out of 64
+	const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Channel-wise minimum and maximum of 16 RGBA pixels
+	void GetBounds(const unsigned char* pixels, unsigned char* minColor, unsigned char* maxColor) {
+		__m128i p0 = _mm_loadu_si128((const __m128i*)pixels);
+		__m128i p1 = _mm_loadu_si128((const __m128i*)(pixels + 16));
+		__m128i p2 = _mm_loadu_si128((const __m128i*)(pixels + 32));
+		__m128i p3 = _mm_loadu_si128((const __m128i*)(pixels + 48));
+
+		__m128i minimum = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+		__m128i maximum = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+
+		// Fold the four pixels of each register into one
+		minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+		minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+		maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(1, 0, 3, 2)));
+		maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		int minimumBits = _mm_cvtsi128_si32(minimum);
+		int maximumBits = _mm_cvtsi128_si32(maximum);
+		memcpy(minColor, &minimumBits, 4);
+		memcpy(maxColor, &maximumBits, 4);
+	}
+
+	// dots[i] = (pixel i - origin) . direction, over all four channels
+	void Project(const unsigned char* pixels, const int* origin, const int* direction, int* dots) {
+		__m128i zero = _mm_setzero_si128();
+		__m128i originLanes = _mm_setr_epi16(
+			origin[0], origin[1], origin[2], origin[3],
+			origin[0], origin[1], origin[2], origin[3]
+		);
+		__m128i directionLanes = _mm_setr_epi16(
+			direction[0], direction[1], direction[2], direction[3],
+			direction[0], direction[1], direction[2], direction[3]
+		);
+
+		for (int i = 0; i < 4; i++) {
+			__m128i p = _mm_loadu_si128((const __m128i*)(pixels + 16 * i));
+			__m128i low = _mm_sub_epi16(_mm_unpacklo_epi8(p, zero), originLanes);
+			__m128i high = _mm_sub_epi16(_mm_unpackhi_epi8(p, zero), originLanes);
+
+			// Each pixel leaves two partial sums, rg and ba, add them up
+			__m128 lowSums = _mm_castsi128_ps(_mm_madd_epi16(low, directionLanes));
+			__m128 highSums = _mm_castsi128_ps(_mm_madd_epi16(high, directionLanes));
+			__m128i even = _mm_castps_si128(_mm_shuffle_ps(lowSums, highSums, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i odd = _mm_castps_si128(_mm_shuffle_ps(lowSums, highSums, _MM_SHUFFLE(3, 1, 3, 1)));
+			_mm_storeu_si128((__m128i*)(dots + 4 * i), _mm_add_epi32(even, odd));
+		}
+	}
+
+	uint16_t To565(const unsigned char* color) {
+		int r = (color[0] * 31 + 127) / 255;
+		int g = (color[1] * 63 + 127) / 255;
+		int b = (color[2] * 31 + 127) / 255;
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void From565(uint16_t packed, int* color) {
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+		color[3] = 0;
+	}
+
+	void WriteLittleEndian(unsigned char* out, uint64_t value, int byteCount) {
+		for (int i = 0; i < byteCount; i++) {
+			out[i] = (unsigned char)(value >> (8 * i));
+		}
+	}
+
+	// Mode 6 endpoints share one p-bit for all four channels, keep the one
+	// that reconstructs the color closest
+	void QuantizeMode6(const unsigned char* color, int* quantized, int* pBit) {
+		int bestError = INT_MAX;
+		for (int p = 0; p < 2; p++) {
+			int candidate[4];
+			int error = 0;
+			for (int c = 0; c < 4; c++) {
+				candidate[c] = std::clamp((color[c] - p + 1) >> 1, 0, 127);
+				int difference = ((candidate[c] << 1) | p) - color[c];
+				error += difference * difference;
+			}
+			if (error < bestError) {
+				bestError = error;
+				memcpy(quantized, candidate, sizeof(candidate));
+				*pBit = p;
+			}
+		}
+	}
+
+	struct BitWriter {
+		uint64_t words[2] = {};
+		int position = 0;
+
+		void Write(uint64_t value, int count) {
+			int word = position >> 6;
+			int shift = position & 63;
+			words[word] |= value << shift;
+			if (shift + count > 64) {
+				words[word + 1] |= value >> (64 - shift);
+			}
+			position += count;
+		}
+	};
+}
+
+void TextureCooker::Cook(std::string imagePath, std::string ddsPath, Format format) {
+	int width, height;
+	unsigned char* pixels = stbi_load(imagePath.c_str(), &width, &height, NULL, 4);
+	if (!pixels) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not decode " + imagePath);
+	}
+
+	// Direct3D only takes block compressed textures made of whole blocks
+	if (width % 4 != 0 || height % 4 != 0) {
+		int targetWidth = (width + 3) & ~3;
+		int targetHeight = (height + 3) & ~3;
+		unsigned char* resized = (unsigned char*)malloc((size_t)targetWidth * targetHeight * 4);
+		ImageProcessing::Resize(pixels, width, height, resized, targetWidth, targetHeight, ImageProcessing::Filter::Lanczos);
+		stbi_image_free(pixels);
+		pixels = resized;
+		width = targetWidth;
+		height = targetHeight;
+	}
+
+	std::vector<Mip> mips = BuildMipChain(pixels, width, height);
+	free(pixels);
+
+	uint32_t dxgiFormat = format == Format::BC1 ? DDS_FORMAT_BC1_UNORM
+		: format == Format::BC3 ? DDS_FORMAT_BC3_UNORM
+		: DDS_FORMAT_BC7_UNORM;
+
+	DdsHeader header = {};
+	header.size = sizeof(DdsHeader);
+	header.flags = DDS_FLAGS_TEXTURE;
+	header.height = height;
+	header.width = width;
+	header.pitchOrLinearSize = (uint32_t)GetDdsMipSize(dxgiFormat, width, height);
+	header.mipMapCount = mips.size();
+	header.pixelFormat.size = sizeof(DdsPixelFormat);
+	header.pixelFormat.flags = DDS_PIXEL_FLAGS_FOURCC;
+	header.pixelFormat.fourCC = DDS_FOURCC_DX10;
+	header.caps = DDS_CAPS_TEXTURE;
+
+	DdsHeaderDx10 headerDx10 = {};
+	headerDx10.dxgiFormat = dxgiFormat;
+	headerDx10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+	headerDx10.arraySize = 1;
+
+	std::ofstream out(ddsPath, std::ios::binary);
+	if (!out) {
+		Main::HandleError(0, __FILE__, __LINE__, "Could not write " + ddsPath);
+	}
+	out.write(DDS_MAGIC, 4);
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)&headerDx10, sizeof(headerDx10));
+	for (Mip& mip : mips) {
+		std::vector<unsigned char> blocks = Encode(mip, format);
+		out.write((const char*)blocks.data(), blocks.size());
+	}
+}
+
+bool TextureCooker::ParseFormat(std::string name, Format* format) {
+	if (name == "bc1") {
+		*format = Format::BC1;
+	}
+	else if (name == "bc3") {
+		*format = Format::BC3;
+	}
+	else if (name == "bc7") {
+		*format = Format::BC7;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+std::vector<TextureCooker::Mip> TextureCooker::BuildMipChain(const unsigned char* pixels, int width, int height) {
+	std::vector<Mip> mips;
+	mips.push_back({ width, height, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4) });
+
+	while (mips.back().width > 1 || mips.back().height > 1) {
+		const Mip& source = mips.back();
+		Mip mip = { std::max(source.width / 2, 1), std::max(source.height / 2, 1) };
+		mip.pixels.resize((size_t)mip.width * mip.height * 4);
+		ImageProcessing::DownsampleSrgb(source.pixels.data(), source.width, source.height, mip.pixels.data());
+		mips.push_back(std::move(mip));
+	}
+
+	return mips;
+}
+
+std::vector<unsigned char> TextureCooker::Encode(const Mip& mip, Format format) {
+	int blockSize = format == Format::BC1 ? 8 : 16;
+	int blocksX = (mip.width + 3) / 4;
+	int blocksY = (mip.height + 3) / 4;
+	std::vector<unsigned char> blocks((size_t)blocksX * blocksY * blockSize);
+
+	JobSystem::GetInstance()->ParallelFor(blocksY, 4, [&](int begin, int end) {
+		unsigned char pixels[16 * 4];
+		for (int by = begin; by < end; by++) {
+			for (int bx = 0; bx < blocksX; bx++) {
+				// Blocks hanging over the edge repeat the last row or column
+				for (int y = 0; y < 4; y++) {
+					int sourceY = std::min(by * 4 + y, mip.height - 1);
+					for (int x = 0; x < 4; x++) {
+						int sourceX = std::min(bx * 4 + x, mip.width - 1);
+						memcpy(&pixels[(y * 4 + x) * 4], &mip.pixels[((size_t)sourceY * mip.width + sourceX) * 4], 4);
+					}
+				}
+
+				unsigned char* block = &blocks[((size_t)by * blocksX + bx) * blockSize];
+				if (format == Format::BC1) {
+					EncodeBC1Block(pixels, block);
+				}
+				else if (format == Format::BC3) {
+					EncodeBC3Block(pixels, block);
+				}
+				else {
+					EncodeBC7Block(pixels, block);
+				}
+			}
+		}
+	});
+
+	return blocks;
+}
+
+void TextureCooker::EncodeBC1Block(const unsigned char* pixels, unsigned char* block) {
+	unsigned char minColor[4], maxColor[4];
+	GetBounds(pixels, minColor, maxColor);
+
+	// Pull the box in a little, its corners are usually further out than any pixel
+	for (int c = 0; c < 3; c++) {
+		int inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	// color0 > color1 selects the four color mode
+	uint16_t color0 = To565(maxColor);
+	uint16_t color1 = To565(minColor);
+	if (color0 < color1) {
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		int endpoint0[4], endpoint1[4];
+		From565(color0, endpoint0);
+		From565(color1, endpoint1);
+
+		int direction[4] = {
+			endpoint0[0] - endpoint1[0],
+			endpoint0[1] - endpoint1[1],
+			endpoint0[2] - endpoint1[2],
+			0
+		};
+		int length = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+		int dots[16];
+		Project(pixels, endpoint1, direction, dots);
+
+		// Palette order is color0, color1, 2/3 color0, 1/3 color0
+		static const int INDEX_FOR_LEVEL[4] = { 1, 3, 2, 0 };
+		for (int i = 0; i < 16; i++) {
+			int level = dots[i] <= 0 ? 0 : std::min((dots[i] * 6 + length) / (2 * length), 3);
+			indices |= INDEX_FOR_LEVEL[level] << (2 * i);
+		}
+	}
+
+	WriteLittleEndian(block, color0, 2);
+	WriteLittleEndian(block + 2, color1, 2);
+	WriteLittleEndian(block + 4, indices, 4);
+}
+
+void TextureCooker::EncodeBC3Block(const unsigned char* pixels, unsigned char* block) {
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for (int i = 0; i < 16; i++) {
+		alpha0 = std::max(alpha0, (int)pixels[i * 4 + 3]);
+		alpha1 = std::min(alpha1, (int)pixels[i * 4 + 3]);
+	}
+
+	// alpha0 > alpha1 selects eight interpolated values, alpha0 first
+	uint64_t indices = 0;
+	if (alpha0 > alpha1) {
+		int range = alpha0 - alpha1;
+		for (int i = 0; i < 16; i++) {
+			int level = ((pixels[i * 4 + 3] - alpha1) * 14 + range) / (2 * range);
+			int index = level == 7 ? 0 : level == 0 ? 1 : 8 - level;
+			indices |= (uint64_t)index << (3 * i);
+		}
+	}
+
+	block[0] = (unsigned char)alpha0;
+	block[1] = (unsigned char)alpha1;
+	WriteLittleEndian(block + 2, indices, 6);
+
+	EncodeBC1Block(pixels, block + 8);
+}
+
+void TextureCooker::EncodeBC7Block(const unsigned char* pixels, unsigned char* block) {
+	unsigned char minColor[4], maxColor[4];
+	GetBounds(pixels, minColor, maxColor);
+
+	int quantized[2][4];
+	int pBits[2];
+	QuantizeMode6(minColor, quantized[0], &pBits[0]);
+	QuantizeMode6(maxColor, quantized[1], &pBits[1]);
+
+	int endpoints[2][4];
+	for (int e = 0; e < 2; e++) {
+		for (int c = 0; c < 4; c++) {
+			endpoints[e][c] = (quantized[e][c] << 1) | pBits[e];
+		}
+	}
+
+	int direction[4];
+	int length = 0;
+	for (int c = 0; c < 4; c++) {
+		direction[c] = endpoints[1][c] - endpoints[0][c];
+		length += direction[c] * direction[c];
+	}
+
+	int indices[16] = {};
+	if (length > 0) {
+		int dots[16];
+		Project(pixels, endpoints[0], direction, dots);
+
+		// Weights are almost evenly spaced, so the nearest one is next to the even guess
+		for (int i = 0; i < 16; i++) {
+			int weight = (int)std::clamp((int64_t)dots[i] * 64 / length, (int64_t)0, (int64_t)64);
+			int index = std::min((weight * 15 + 32) / 64, 15);
+			if (index > 0 && weight - BC7_WEIGHTS[index - 1] < BC7_WEIGHTS[index] - weight) {
+				index--;
+			}
+			else if (index < 15 && BC7_WEIGHTS[index + 1] - weight < weight - BC7_WEIGHTS[index]) {
+				index++;
+			}
+			indices[i] = index;
+		}
+	}
+
+	// The first index is stored without its top bit, so it has to be below 8
+	if (indices[0] >= 8) {
+		std::swap(quantized[0], quantized[1]);
+		std::swap(pBits[0], pBits[1]);
+		for (int i = 0; i < 16; i++) {
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	BitWriter bits;
+	bits.Write(1 << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		bits.Write(quantized[0][c], 7);
+		bits.Write(quantized[1][c], 7);
+	}
+	bits.Write(pBits[0], 1);
+	bits.Write(pBits[1], 1);
+	bits.Write(indices[0], 3);
+	for (int i = 1; i < 16; i++) {
+		bits.Write(indices[i], 4);
+	}
+
+	WriteLittleEndian(block, bits.words[0], 8);
+	WriteLittleEndian(block + 8, bits.words[1], 8);
+}
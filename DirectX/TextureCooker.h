@@ -0,0 +1,39 @@
+#ifndef H_TEXTURECOOKER
+#define H_TEXTURECOOKER
+#include <string>
+#include <vector>
+
+// Turns an image file into a block compressed DDS with a full mip chain, so
+// the runtime uploads it as is instead of decoding a JPEG into uncompressed
+// pixels. Blocks are encoded with SSE2 on every JobSystem thread.
+//   BC1	RGB, 4 bits per pixel
+//   BC3	RGBA, 8 bits per pixel, BC1 color with a separate alpha block
+//   BC7	RGBA, 8 bits per pixel, mode 6 only, the best quality of the three
+class TextureCooker {
+public:
+	enum class Format {
+		BC1,
+		BC3,
+		BC7,
+	};
+
+	static void Cook(std::string imagePath, std::string ddsPath, Format format);
+
+	// bc1, bc3 or bc7, false for anything else
+	static bool ParseFormat(std::string name, Format* format);
+
+	// 16 RGBA pixels in, one encoded block out
+	static void EncodeBC1Block(const unsigned char* pixels, unsigned char* block);
+	static void EncodeBC3Block(const unsigned char* pixels, unsigned char* block);
+	static void EncodeBC7Block(const unsigned char* pixels, unsigned char* block);
+private:
+	struct Mip {
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+	};
+
+	static std::vector<Mip> BuildMipChain(const unsigned char* pixels, int width, int height);
+	static std::vector<unsigned char> Encode(const Mip& mip, Format format);
+};
+#endif
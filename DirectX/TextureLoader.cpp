@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "TextureLoader.h"
+#include "DdsFormat.h"
+#include "ImageProcessing.h"
+#include "stb_image.h"
+
+TextureLoader* TextureLoader::GetInstance() {
+	if (!instance) {
+		instance = new TextureLoader();
+	}
+	return instance;
+}
+
+TextureLoader::TextureLoader()
+	:
+	pendingCount(0)
+{
+	// The threads live as long as the process, like every other singleton
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		std::thread(&TextureLoader::ThreadLoop, this).detach();
+	}
+}
+
+void TextureLoader::Request(Texture::Image* image, std::string path, int firstMip) {
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		requests.push_back({ image, path, firstMip });
+	}
+	requestAdded.notify_one();
+	pendingCount++;
+}
+
+void TextureLoader::ProcessCompleted() {
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		processing.swap(results);
+	}
+
+	for (LoadResult& result : processing) {
+		// Images that failed to decode keep no data and draw with their face colors
+		*result.image = result.loaded;
+		result.image->loaded = true;
+	}
+	pendingCount -= processing.size();
+	processing.clear();
+}
+
+int TextureLoader::GetPendingCount() {
+	return pendingCount;
+}
+
+void TextureLoader::ThreadLoop() {
+	while (true) {
+		LoadRequest request;
+		{
+			std::unique_lock<std::mutex> lock(requestMutex);
+			requestAdded.wait(lock, [this]() { return requests.size() > 0; });
+			request = requests.front();
+			requests.pop_front();
+		}
+
+		LoadResult result = { request.image, *request.image };
+		std::string cookedPath = request.path.substr(0, request.path.rfind('.')) + ".dds";
+		if (!LoadDds(cookedPath, &result.loaded, request.firstMip) && request.firstMip == MIP_TAIL) {
+			Decode(request.path, &result.loaded);
+		}
+
+		std::lock_guard<std::mutex> lock(resultMutex);
+		results.push_back(result);
+	}
+}
+
+bool TextureLoader::LoadDds(std::string path, Texture::Image* image, int firstMip) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	size_t fileSize = file.tellg();
+	file.seekg(0);
+
+	char magic[4];
+	DdsHeader header;
+	DdsHeaderDx10 headerDx10;
+	size_t headerSize = sizeof(magic) + sizeof(header) + sizeof(headerDx10);
+	if (fileSize < headerSize
+		|| !file.read(magic, sizeof(magic))
+		|| !file.read((char*)&header, sizeof(header))
+		|| !file.read((char*)&headerDx10, sizeof(headerDx10))
+		|| memcmp(magic, DDS_MAGIC, sizeof(magic)) != 0
+		|| header.pixelFormat.fourCC != DDS_FOURCC_DX10
+		|| headerDx10.resourceDimension != DDS_DIMENSION_TEXTURE2D
+		|| headerDx10.arraySize != 1
+		|| header.width == 0 || header.height == 0) {
+		return false;
+	}
+
+	uint32_t format = headerDx10.dxgiFormat;
+	if (format != DDS_FORMAT_R8G8B8A8_UNORM && GetDdsBlockSize(format) == 0) {
+		return false;
+	}
+
+	int mipCount = header.mipMapCount > 0 ? header.mipMapCount : 1;
+	if (firstMip == MIP_TAIL) {
+		firstMip = 0;
+		while (firstMip < mipCount - 1 && std::max(header.width >> firstMip, header.height >> firstMip) > MIP_TAIL_SIZE) {
+			firstMip++;
+		}
+	}
+	firstMip = std::min(firstMip, GetDdsCoarsestFirstMip(format, header.width, header.height, mipCount));
+
+	// The finer mips come first in the file and are skipped over
+	size_t offset = 0;
+	size_t size = 0;
+	for (int i = 0; i < mipCount; i++) {
+		size_t mipSize = GetDdsMipSize(format, std::max(header.width >> i, 1u), std::max(header.height >> i, 1u));
+		if (i < firstMip) {
+			offset += mipSize;
+		}
+		else {
+			size += mipSize;
+		}
+	}
+	if (fileSize - headerSize < offset + size) {
+		return false;
+	}
+
+	unsigned char* data = (unsigned char*)malloc(size);
+	if (!file.seekg(headerSize + offset) || !file.read((char*)data, size)) {
+		free(data);
+		return false;
+	}
+
+	image->data = data;
+	image->width = header.width;
+	image->height = header.height;
+	image->format = format;
+	image->mipCount = mipCount;
+	image->size = size;
+	image->firstMip = firstMip;
+	image->streamable = true;
+	return true;
+}
+
+void TextureLoader::Decode(std::string path, Texture::Image* image) {
+	int width, height, channelCount;
+	unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channelCount, 0);
+	if (!pixels) {
+		return;
+	}
+
+	if (channelCount != 4) {
+		unsigned char* expanded = (unsigned char*)malloc((size_t)width * height * 4);
+		ImageProcessing::ExpandToRgba(pixels, channelCount, width * height, expanded);
+		stbi_image_free(pixels);
+		pixels = expanded;
+	}
+
+	// Oversized files are shrunk here, once, instead of costing memory and bandwidth every frame
+	if (width > MAX_TEXTURE_SIZE || height > MAX_TEXTURE_SIZE) {
+		float scale = (float)MAX_TEXTURE_SIZE / std::max(width, height);
+		int targetWidth = std::max((int)(width * scale), 1);
+		int targetHeight = std::max((int)(height * scale), 1);
+		unsigned char* resized = (unsigned char*)malloc((size_t)targetWidth * targetHeight * 4);
+		ImageProcessing::Resize(pixels, width, height, resized, targetWidth, targetHeight, ImageProcessing::Filter::Lanczos);
+		free(pixels);
+		pixels = resized;
+		width = targetWidth;
+		height = targetHeight;
+	}
+
+	// Every mip down to 1x1, one after the other like in a cooked file
+	int mipCount = 1;
+	size_t size = (size_t)width * height * 4;
+	for (int w = width, h = height; w > 1 || h > 1; mipCount++) {
+		w = std::max(w / 2, 1);
+		h = std::max(h / 2, 1);
+		size += (size_t)w * h * 4;
+	}
+
+	unsigned char* data = (unsigned char*)realloc(pixels, size);
+	unsigned char* mip = data;
+	for (int i = 1, w = width, h = height; i < mipCount; i++) {
+		unsigned char* next = mip + (size_t)w * h * 4;
+		ImageProcessing::DownsampleSrgb(mip, w, h, next);
+		mip = next;
+		w = std::max(w / 2, 1);
+		h = std::max(h / 2, 1);
+	}
+
+	image->data = data;
+	image->width = width;
+	image->height = height;
+	image->format = DDS_FORMAT_R8G8B8A8_UNORM;
+	image->mipCount = mipCount;
+	image->size = size;
+	image->firstMip = 0;
+	image->streamable = false;
+}
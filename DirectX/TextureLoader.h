@@ -0,0 +1,74 @@
+#ifndef H_TEXTURELOADER
+#define H_TEXTURELOADER
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Texture.h"
+
+// Decodes texture files on a few loader threads of its own, so disk reads and
+// decoding never run on the main thread. A DDS cooked by TextureCooker next to
+// the requested file is loaded instead of the file itself, only from the
+// requested mip down. The loader threads only fill buffers they own, finished
+// images are handed back through a completion queue that the main thread
+// drains before it renders.
+class TextureLoader {
+public:
+	static TextureLoader* GetInstance();
+
+	TextureLoader(TextureLoader& textureLoader) = delete;
+
+	// Cooked files start with the mips no larger than this
+	static const int MIP_TAIL = -1;
+	static const int MIP_TAIL_SIZE = 64;
+
+	// The image keeps its placeholder state until the main thread picks up the
+	// result. Mips finer than firstMip are skipped, files that are not cooked
+	// are always decoded whole and only for MIP_TAIL requests.
+	void Request(Texture::Image* image, std::string path, int firstMip);
+
+	// Main thread, publishes every image finished since the last call
+	void ProcessCompleted();
+
+	// Requested images the main thread has not received yet
+	int GetPendingCount();
+private:
+	TextureLoader();
+	inline static TextureLoader* instance;
+
+	// Decoding is mostly waiting on the disk, a couple of threads is plenty
+	static const int THREAD_COUNT = 2;
+	// Larger decoded images are scaled down to fit
+	static const int MAX_TEXTURE_SIZE = 2048;
+
+	struct LoadRequest {
+		Texture::Image* image;
+		std::string path;
+		int firstMip;
+	};
+
+	struct LoadResult {
+		Texture::Image* image;
+		Texture::Image loaded;
+	};
+
+	std::mutex requestMutex;
+	std::condition_variable requestAdded;
+	std::deque<LoadRequest> requests;
+
+	std::mutex resultMutex;
+	std::vector<LoadResult> results;
+	std::vector<LoadResult> processing;
+
+	int pendingCount;
+
+	void ThreadLoop();
+
+	// Cooked mips are kept as they are in the file, the GPU reads them directly
+	static bool LoadDds(std::string path, Texture::Image* image, int firstMip);
+
+	// RGBA with a full mip chain, data stays nullptr if the file cannot be decoded
+	static void Decode(std::string path, Texture::Image* image);
+};
+#endif
@@ -1,7 +1,7 @@
 #include "TransformConstantBuffer.h"
 #include "Shape.h"
-#include "Window.h"
-#include "Graphics.h"
+#include "GameObject.h"
+#include "Camera.h"
 #include "Game.h"
 
 TransformConstantBuffer::TransformConstantBuffer()
@@ -18,40 +18,12 @@ size_t TransformConstantBuffer::GetBufferSize() {
 }
 
 const void* TransformConstantBuffer::GetBufferData(Shape* shape) {
-    btTransform shapeTransform = shape->GetTransform();
-    btVector3 shapeSize = shape->GetScale();
+    Camera* camera = Game::GetInstance()->GetMainCamera();
 
-    dx::XMVECTOR shapeQuaternion = dx::XMVectorSet((float)shapeTransform.getRotation().x(), (float)shapeTransform.getRotation().y(), (float)shapeTransform.getRotation().z(), (float)shapeTransform.getRotation().w());
-
-    RECT clientRect;
-    GetClientRect(Window::GetInstance()->GetHandle(), &clientRect);
-    float squeeze = (float)clientRect.bottom / (float)clientRect.right;
-
-    dx::XMMATRIX worldTransformation =
-        dx::XMMatrixScaling(shapeSize.x(), shapeSize.y(), shapeSize.z()) *
-        dx::XMMatrixRotationQuaternion(shapeQuaternion) *
-        dx::XMMatrixTranslation(shapeTransform.getOrigin().x(), shapeTransform.getOrigin().y(), shapeTransform.getOrigin().z())
-        ;
-
-    dx::XMMATRIX viewTransformation =
-        Game::GetInstance()->GetMainCamera()->GetMatrix()
-        ;
-
-    dx::XMMATRIX projectionTransformation =
-        dx::XMMatrixPerspectiveLH(1.0f, squeeze, Graphics::GetInstance()->GetNearZ(), Graphics::GetInstance()->GetFarZ())
-        ;
-
-
-    worldTransformation = dx::XMMatrixTranspose(worldTransformation);
-    viewTransformation = dx::XMMatrixTranspose(viewTransformation);
-    projectionTransformation = dx::XMMatrixTranspose(projectionTransformation);
-
-    Data data = {
-        // Object transform
-        worldTransformation,
-        viewTransformation,
-        projectionTransformation
-    };
+    // The matrices are cached, only the transposes for HLSL happen per draw
+    data.worldTransformation = dx::XMMatrixTranspose(shape->GetGameObject()->GetWorldMatrix());
+    data.viewTransformation = dx::XMMatrixTranspose(camera->GetMatrix());
+    data.projectionTransformation = dx::XMMatrixTranspose(camera->GetProjectionMatrix());
 
     return &data;
 }
@@ -13,4 +13,6 @@ protected:
 	UINT GetSlotNumber() override;
 	size_t GetBufferSize() override;
 	const void* GetBufferData(Shape* shape) override;
+private:
+	Data data;
 };
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include "TransformHierarchy.h"
+#include "Main.h"
+#include "JobSystem.h"
+
+namespace {
+	const int BATCH_SIZE = 256;
+}
+
+TransformHierarchy* TransformHierarchy::GetInstance() {
+	if (!instance) {
+		instance = new TransformHierarchy();
+		Register(instance);
+	}
+	return instance;
+}
+
+TransformHierarchy::TransformHierarchy()
+	:
+	needsSort(false),
+	levelStarts({ 0 })
+{}
+
+int TransformHierarchy::GetUpdateOrder() {
+	return UPDATE_ORDER;
+}
+
+AccessMask TransformHierarchy::GetReads() {
+	return ACCESS_TRANSFORM;
+}
+
+AccessMask TransformHierarchy::GetWrites() {
+	return ACCESS_TRANSFORM;
+}
+
+bool TransformHierarchy::IsMainThreadOnly() {
+	return false;
+}
+
+void TransformHierarchy::Reserve(int count) {
+	int size = locals.size() + count;
+	locals.reserve(size);
+	worlds.reserve(size);
+	scales.reserve(size);
+	matrices.reserve(size);
+	bounds.reserve(size);
+	parents.reserve(size);
+	flags.reserve(size);
+	visibility.reserve(size);
+	nodes.reserve(size);
+	owners.reserve(size);
+	nodeToIndex.reserve(nodeToIndex.size() + count);
+}
+
+int TransformHierarchy::CreateNode(GameObject* owner, btTransform world, btVector3 scale) {
+	int node;
+	if (freeNodes.size() > 0) {
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	}
+	else {
+		node = nodeToIndex.size();
+		nodeToIndex.push_back(-1);
+	}
+
+	// Roots can go anywhere, appending keeps every parent in front of its children
+	nodeToIndex[node] = locals.size();
+	locals.push_back(world);
+	worlds.push_back(world);
+	scales.push_back(scale);
+	matrices.push_back(dx::XMMatrixIdentity());
+	bounds.push_back(dx::BoundingBox());
+	parents.push_back(-1);
+	flags.push_back(FLAG_DIRTY | FLAG_INHERIT_ROTATION);
+	visibility.push_back(VISIBLE_CAMERA | VISIBLE_SHADOW);
+	nodes.push_back(node);
+	owners.push_back(owner);
+
+	// Valid right away for objects created after this frame's pass
+	UpdateMatrix(locals.size() - 1);
+
+	return node;
+}
+
+void TransformHierarchy::DestroyNode(int node) {
+	int index = nodeToIndex[node];
+
+	// The entry stays until the next sort so its children can still be detached,
+	// and the id is only reused once the entry is gone
+	flags[index] |= FLAG_DEAD;
+	owners[index] = nullptr;
+	nodeToIndex[node] = -1;
+	needsSort = true;
+}
+
+void TransformHierarchy::SetParent(int node, int parent, bool inheritRotation) {
+	int index = nodeToIndex[node];
+	int parentIndex = parent < 0 ? -1 : nodeToIndex[parent];
+
+	for (int ancestor = parentIndex; ancestor >= 0; ancestor = parents[ancestor]) {
+		if (ancestor == index) {
+			Main::HandleError(0, __FILE__, __LINE__, "Tried to parent a transform to one of its descendants");
+		}
+	}
+
+	btTransform world = GetWorld(node);
+
+	if (inheritRotation) {
+		flags[index] |= FLAG_INHERIT_ROTATION;
+	}
+	else {
+		flags[index] &= ~FLAG_INHERIT_ROTATION;
+	}
+
+	parents[index] = parentIndex;
+	locals[index] = parentIndex < 0 ? world : Decompose(GetWorldAt(parentIndex), world, flags[index]);
+	worlds[index] = world;
+	flags[index] |= FLAG_DIRTY;
+	needsSort = true;
+}
+
+int TransformHierarchy::GetParent(int node) {
+	int parentIndex = parents[nodeToIndex[node]];
+	return parentIndex < 0 ? -1 : nodes[parentIndex];
+}
+
+GameObject* TransformHierarchy::GetOwner(int node) {
+	return owners[nodeToIndex[node]];
+}
+
+btTransform TransformHierarchy::GetWorld(int node) {
+	return GetWorldAt(nodeToIndex[node]);
+}
+
+btTransform TransformHierarchy::GetWorldAt(int index) {
+	// Walk up instead of reading the cache so the result is right even when an
+	// ancestor moved since the last pass
+	int parentIndex = parents[index];
+	if (parentIndex < 0) {
+		return worlds[index];
+	}
+	return Compose(GetWorldAt(parentIndex), locals[index], flags[index]);
+}
+
+btTransform TransformHierarchy::GetLocal(int node) {
+	return locals[nodeToIndex[node]];
+}
+
+void TransformHierarchy::SetWorld(int node, btTransform world) {
+	int index = nodeToIndex[node];
+	int parentIndex = parents[index];
+
+	locals[index] = parentIndex < 0 ? world : Decompose(GetWorldAt(parentIndex), world, flags[index]);
+	worlds[index] = world;
+	flags[index] |= FLAG_DIRTY;
+}
+
+void TransformHierarchy::SetLocal(int node, btTransform local) {
+	int index = nodeToIndex[node];
+	int parentIndex = parents[index];
+
+	locals[index] = local;
+	worlds[index] = parentIndex < 0 ? local : Compose(GetWorldAt(parentIndex), local, flags[index]);
+	flags[index] |= FLAG_DIRTY;
+}
+
+btVector3 TransformHierarchy::GetScale(int node) {
+	return scales[nodeToIndex[node]];
+}
+
+void TransformHierarchy::SetScale(int node, btVector3 scale) {
+	int index = nodeToIndex[node];
+	scales[index] = scale;
+	flags[index] |= FLAG_DIRTY;
+}
+
+const dx::XMMATRIX& TransformHierarchy::GetWorldMatrix(int node) {
+	return matrices[nodeToIndex[node]];
+}
+
+const dx::BoundingBox& TransformHierarchy::GetWorldBounds(int node) {
+	return bounds[nodeToIndex[node]];
+}
+
+void TransformHierarchy::Cull(const dx::BoundingFrustum& cameraFrustum, const dx::BoundingFrustum& shadowFrustum) {
+	JobSystem::GetInstance()->ParallelFor(bounds.size(), BATCH_SIZE, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			uint8_t nodeVisibility = 0;
+			if (cameraFrustum.Contains(bounds[i]) != dx::DISJOINT) {
+				nodeVisibility |= VISIBLE_CAMERA;
+			}
+			if (shadowFrustum.Contains(bounds[i]) != dx::DISJOINT) {
+				nodeVisibility |= VISIBLE_SHADOW;
+			}
+			visibility[i] = nodeVisibility;
+		}
+	});
+}
+
+bool TransformHierarchy::IsVisible(int node, bool shadowPass) {
+	return (visibility[nodeToIndex[node]] & (shadowPass ? VISIBLE_SHADOW : VISIBLE_CAMERA)) != 0;
+}
+
+void TransformHierarchy::Update() {
+	if (needsSort) {
+		Sort();
+	}
+
+	// A level only reads the levels above it, so its nodes can update in parallel
+	for (int level = 0; level < levelStarts.size(); level++) {
+		int levelStart = levelStarts[level];
+		int levelEnd = level + 1 < levelStarts.size() ? levelStarts[level + 1] : locals.size();
+
+		JobSystem::GetInstance()->ParallelFor(levelEnd - levelStart, BATCH_SIZE, [this, levelStart](int begin, int end) {
+			for (int i = levelStart + begin; i < levelStart + end; i++) {
+				UpdateNode(i);
+			}
+		});
+	}
+}
+
+void TransformHierarchy::UpdateNode(int index) {
+	uint8_t nodeFlags = flags[index];
+	int parentIndex = parents[index];
+
+	bool changed = (nodeFlags & FLAG_DIRTY) || (parentIndex >= 0 && (flags[parentIndex] & FLAG_CHANGED));
+	if (changed && parentIndex >= 0) {
+		worlds[index] = Compose(worlds[parentIndex], locals[index], nodeFlags);
+	}
+	if (changed) {
+		UpdateMatrix(index);
+	}
+
+	nodeFlags &= ~(FLAG_DIRTY | FLAG_CHANGED);
+	flags[index] = changed ? nodeFlags | FLAG_CHANGED : nodeFlags;
+}
+
+btTransform TransformHierarchy::Compose(btTransform parentWorld, btTransform local, uint8_t flags) {
+	if (flags & FLAG_INHERIT_ROTATION) {
+		return parentWorld * local;
+	}
+	return btTransform(local.getBasis(), parentWorld.getOrigin() + local.getOrigin());
+}
+
+btTransform TransformHierarchy::Decompose(btTransform parentWorld, btTransform world, uint8_t flags) {
+	if (flags & FLAG_INHERIT_ROTATION) {
+		return parentWorld.inverse() * world;
+	}
+	return btTransform(world.getBasis(), world.getOrigin() - parentWorld.getOrigin());
+}
+
+void TransformHierarchy::UpdateMatrix(int index) {
+	// DirectXMath multiplies row vectors, so the rows are the scaled basis columns
+	btMatrix3x3 basis = worlds[index].getBasis();
+	btVector3 origin = worlds[index].getOrigin();
+	btVector3 scale = scales[index];
+	btVector3 x = basis.getColumn(0) * scale.x();
+	btVector3 y = basis.getColumn(1) * scale.y();
+	btVector3 z = basis.getColumn(2) * scale.z();
+
+	matrices[index] = dx::XMMATRIX(
+		(float)x.x(), (float)x.y(), (float)x.z(), 0.0f,
+		(float)y.x(), (float)y.y(), (float)y.z(), 0.0f,
+		(float)z.x(), (float)z.y(), (float)z.z(), 0.0f,
+		(float)origin.x(), (float)origin.y(), (float)origin.z(), 1.0f
+	);
+
+	// Every mesh fits in the [-1, 1] cube
+	dx::BoundingBox meshBounds(dx::XMFLOAT3(0.0f, 0.0f, 0.0f), dx::XMFLOAT3(1.0f, 1.0f, 1.0f));
+	meshBounds.Transform(bounds[index], matrices[index]);
+}
+
+void TransformHierarchy::Sort() {
+	int count = locals.size();
+
+	// Children of destroyed nodes become roots and keep their world transform
+	for (int i = 0; i < count; i++) {
+		if (!(flags[i] & FLAG_DEAD) && parents[i] >= 0 && (flags[parents[i]] & FLAG_DEAD)) {
+			btTransform world = GetWorldAt(i);
+			locals[i] = world;
+			worlds[i] = world;
+			parents[i] = -1;
+			flags[i] |= FLAG_DIRTY;
+		}
+	}
+
+	// Depth of every live entry, parents are not necessarily in front yet
+	std::vector<int> depths(count, -1);
+	std::vector<int> order;
+	order.reserve(count);
+	for (int i = 0; i < count; i++) {
+		if (flags[i] & FLAG_DEAD) {
+			freeNodes.push_back(nodes[i]);
+			continue;
+		}
+
+		int depth = 0;
+		for (int ancestor = parents[i]; ancestor >= 0; ancestor = parents[ancestor]) {
+			if (depths[ancestor] >= 0) {
+				depth += depths[ancestor] + 1;
+				break;
+			}
+			depth++;
+		}
+		depths[i] = depth;
+		order.push_back(i);
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&depths](int a, int b) {
+		return depths[a] < depths[b];
+	});
+
+	std::vector<int> oldToNew(count, -1);
+	levelStarts.assign(1, 0);
+	for (int i = 0; i < order.size(); i++) {
+		oldToNew[order[i]] = i;
+		if (i > 0 && depths[order[i]] != depths[order[i - 1]]) {
+			levelStarts.push_back(i);
+		}
+	}
+
+	std::vector<btTransform> sortedLocals(order.size());
+	std::vector<btTransform> sortedWorlds(order.size());
+	std::vector<btVector3> sortedScales(order.size());
+	std::vector<dx::XMMATRIX> sortedMatrices(order.size());
+	std::vector<dx::BoundingBox> sortedBounds(order.size());
+	std::vector<int> sortedParents(order.size());
+	std::vector<uint8_t> sortedFlags(order.size());
+	std::vector<uint8_t> sortedVisibility(order.size());
+	std::vector<int> sortedNodes(order.size());
+	std::vector<GameObject*> sortedOwners(order.size());
+	for (int i = 0; i < order.size(); i++) {
+		int old = order[i];
+		sortedLocals[i] = locals[old];
+		sortedWorlds[i] = worlds[old];
+		sortedScales[i] = scales[old];
+		sortedMatrices[i] = matrices[old];
+		sortedBounds[i] = bounds[old];
+		sortedParents[i] = parents[old] < 0 ? -1 : oldToNew[parents[old]];
+		sortedFlags[i] = flags[old];
+		sortedVisibility[i] = visibility[old];
+		sortedNodes[i] = nodes[old];
+		sortedOwners[i] = owners[old];
+		nodeToIndex[nodes[old]] = i;
+	}
+
+	locals.swap(sortedLocals);
+	worlds.swap(sortedWorlds);
+	scales.swap(sortedScales);
+	matrices.swap(sortedMatrices);
+	bounds.swap(sortedBounds);
+	parents.swap(sortedParents);
+	flags.swap(sortedFlags);
+	visibility.swap(sortedVisibility);
+	nodes.swap(sortedNodes);
+	owners.swap(sortedOwners);
+	needsSort = false;
+}
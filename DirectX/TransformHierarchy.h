@@ -0,0 +1,101 @@
+#ifndef H_TRANSFORMHIERARCHY
+#define H_TRANSFORMHIERARCHY
+#include <vector>
+#include <cstdint>
+#include <DirectXCollision.h>
+#include "btBulletDynamicsCommon.h"
+#include "Main.h"
+#include "System.h"
+
+class GameObject;
+
+// Owns the transform of every GameObject. Nodes are stored in flat arrays
+// sorted by depth so a parent always comes before its children, and the world
+// transforms are refreshed in one linear pass that only touches dirty nodes and
+// the subtrees below them. The same pass keeps a world matrix and a world
+// bounding box per node, which rendering and culling read instead of rebuilding
+// them from the btTransform on every draw.
+class TransformHierarchy : public System {
+public:
+	static TransformHierarchy* GetInstance();
+
+	static const int UPDATE_ORDER = UPDATE_ORDER_TRANSFORM;
+
+	// Makes room for count more nodes up front, for bulk loads
+	void Reserve(int count);
+	int CreateNode(GameObject* owner, btTransform world, btVector3 scale);
+	void DestroyNode(int node);
+
+	// A parent of -1 makes the node a root. Without inheritRotation the node only
+	// follows the position of its parent.
+	void SetParent(int node, int parent, bool inheritRotation);
+	int GetParent(int node);
+	GameObject* GetOwner(int node);
+
+	btTransform GetWorld(int node);
+	btTransform GetLocal(int node);
+	void SetWorld(int node, btTransform world);
+	void SetLocal(int node, btTransform local);
+	btVector3 GetScale(int node);
+	void SetScale(int node, btVector3 scale);
+
+	// Scale * rotation * translation, current as of the last pass
+	const dx::XMMATRIX& GetWorldMatrix(int node);
+	const dx::BoundingBox& GetWorldBounds(int node);
+
+	// Tests every node's bounds once, the shadow map is rendered without a view
+	// transform so it gets its own frustum
+	void Cull(const dx::BoundingFrustum& cameraFrustum, const dx::BoundingFrustum& shadowFrustum);
+	bool IsVisible(int node, bool shadowPass);
+
+	void Update() override;
+	int GetUpdateOrder() override;
+	AccessMask GetReads() override;
+	AccessMask GetWrites() override;
+	bool IsMainThreadOnly() override;
+private:
+	TransformHierarchy();
+	inline static TransformHierarchy* instance;
+
+	enum Flags : uint8_t {
+		FLAG_DIRTY = 1 << 0,
+		FLAG_CHANGED = 1 << 1,
+		FLAG_INHERIT_ROTATION = 1 << 2,
+		FLAG_DEAD = 1 << 3,
+	};
+
+	// Kept apart from the flags so culling can write it while other systems read transforms
+	enum Visibility : uint8_t {
+		VISIBLE_CAMERA = 1 << 0,
+		VISIBLE_SHADOW = 1 << 1,
+	};
+
+	// Indexed by position in the sorted arrays
+	std::vector<btTransform> locals;
+	std::vector<btTransform> worlds;
+	std::vector<btVector3> scales;
+	std::vector<dx::XMMATRIX> matrices;
+	std::vector<dx::BoundingBox> bounds;
+	std::vector<int> parents;
+	std::vector<uint8_t> flags;
+	std::vector<uint8_t> visibility;
+	std::vector<int> nodes;
+	std::vector<GameObject*> owners;
+
+	// Node ids stay stable while the arrays get sorted
+	std::vector<int> nodeToIndex;
+	std::vector<int> freeNodes;
+	bool needsSort;
+
+	// First index of every depth level, nodes appended since the last sort are
+	// roots and count as part of the last level
+	std::vector<int> levelStarts;
+
+	btTransform GetWorldAt(int index);
+	btTransform Compose(btTransform parentWorld, btTransform local, uint8_t flags);
+	btTransform Decompose(btTransform parentWorld, btTransform world, uint8_t flags);
+	void UpdateNode(int index);
+	void UpdateMatrix(int index);
+	void Sort();
+};
+#endif
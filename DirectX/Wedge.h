@@ -2,6 +2,9 @@
 
 class Wedge : public ShapeBase<Wedge> {
 public:
+	static const ComponentType TYPE = COMPONENT_TYPE_WEDGE;
+	static const ComponentMask MASK = COMPONENT_MASK(TYPE) | Shape::MASK;
+
 	Wedge(GameObject* gameObject);
 protected:
 	void SetupVertices() override;
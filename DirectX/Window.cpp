@@ -58,16 +58,7 @@ Window::Window(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, in
     // display the window on the screen
     ShowWindow(hWnd, nCmdShow);
 
-    // Register the mouse for raw input
-    RAWINPUTDEVICE rid;
-    ZeroMemory(&rid, sizeof(rid));
-    rid.usUsagePage = 0x01;
-    rid.usUsage = 0x02;
-    rid.dwFlags = 0;
-    rid.hwndTarget = NULL;
-    if (!RegisterRawInputDevices(&rid, 1, sizeof(rid))) {
-        throw new std::exception("Failed to create rawinput device");
-    }
+    // Raw input is registered by the InputThread
 }
 
 // Forward declare message handler from imgui_impl_win32.cpp
@@ -1,84 +1,162 @@
 // console.cpp : This file contains the 'main' function. Program execution begins and ends there.
 //
+// Physics step benchmark, "console 4000" steps a pile of 4000 boxes in the
+// single threaded world and then in the multithreaded one on 1 to N threads.
+// Every run starts from a PhysicsSnapshot of the pile, restored in place.
+// Before that it checks the SpscQueue the input thread hands events over with.
 
-#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
 #include "btBulletDynamicsCommon.h"
+#include "JobSystem.h"
+#include "PhysicsSnapshot.h"
+#include "PhysicsTaskScheduler.h"
+#include "SpscQueue.h"
 
-int main()
-{
-	// Create the configuration
-	btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
-
-	// Create the collision dispatcher
-	btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
+const int WARMUP_STEPS = 60;
+const int TIMED_STEPS = 300;
 
-	// ???
-	btBroadphaseInterface* overlappingPairCache = new btDbvtBroadphase();
+struct Scene {
+	btDiscreteDynamicsWorld* dynamicsWorld;
+	PhysicsSnapshot start;
+};
 
-	// Constraint solver
-	btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver();
-	
-	// Create the world
-	btDiscreteDynamicsWorld* dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher,
-		overlappingPairCache, solver, collisionConfiguration);
-
-	// Set the gravity
-	dynamicsWorld -> setGravity(btVector3(0, -10, 0));
+// Columns of boxes on a ground box, close enough that they topple into each other
+Scene CreateScene(bool multithreaded, int bodyCount) {
+	Scene scene;
+	scene.dynamicsWorld = PhysicsTaskScheduler::CreateWorld(multithreaded);
+	scene.dynamicsWorld->setGravity(btVector3(0, -9.81f, 0));
 
 	{
 		// Create the ground
-		btCollisionShape* groundShape = new btBoxShape(btVector3(btScalar(50.), btScalar(50.), btScalar(50.)));
+		btCollisionShape* groundShape = new btBoxShape(btVector3(btScalar(200.), btScalar(50.), btScalar(200.)));
 		btTransform groundTransform;
 		groundTransform.setIdentity();
-		groundTransform.setOrigin(btVector3(0, -56, 0));
-		btScalar mass(0.);
-		bool isDynamic = (mass != 0.f);
-		btVector3 localInertia(0, 0, 0);
-		if (isDynamic)
-			groundShape->calculateLocalInertia(mass, localInertia);
-		btDefaultMotionState* myMotionState = new btDefaultMotionState(groundTransform);
-		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, groundShape, localInertia);
-		btRigidBody* body = new btRigidBody(rbInfo);
-		dynamicsWorld->addRigidBody(body);
+		groundTransform.setOrigin(btVector3(0, -50, 0));
+		btRigidBody::btRigidBodyConstructionInfo rbInfo(0, new btDefaultMotionState(groundTransform), groundShape);
+		scene.dynamicsWorld->addRigidBody(new btRigidBody(rbInfo));
 	}
 
-	{
-		// Create the box
-		btCollisionShape* groundShape = new btBoxShape(btVector3(btScalar(1), btScalar(1), btScalar(1)));
+	btCollisionShape* boxShape = new btBoxShape(btVector3(0.5f, 0.5f, 0.5f));
+	btVector3 localInertia(0, 0, 0);
+	boxShape->calculateLocalInertia(1, localInertia);
 
-		btTransform groundTransform;
-		groundTransform.setIdentity();
-		//groundTransform.setOrigin(btVector3(0, 6, 0));
-
-		btScalar mass(1);
-		bool isDynamic = (mass != 0.f);
-		btVector3 localInertia(0, 0, 0);
-		if (isDynamic)
-			groundShape->calculateLocalInertia(mass, localInertia);
-		btDefaultMotionState* myMotionState = new btDefaultMotionState(groundTransform);
-		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, groundShape, localInertia);
-		btRigidBody* body = new btRigidBody(rbInfo);
-		dynamicsWorld->addRigidBody(body);
+	int side = 1;
+	while (side * side * side < bodyCount) {
+		side++;
 	}
+	for (int i = 0; i < bodyCount; i++) {
+		int x = i % side;
+		int z = (i / side) % side;
+		int y = i / (side * side);
 
-	for (int i = 0; i < 100; i++) {
-		dynamicsWorld->stepSimulation(1.0f / 60.0f, 10);
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(btVector3((x - side / 2) * 1.1f, 0.5f + y * 1.05f, (z - side / 2) * 1.1f + y * 0.1f));
 
-		for (int j = 0; j < dynamicsWorld->getNumCollisionObjects(); j++) {
-			btCollisionObject* collisionObject = dynamicsWorld->getCollisionObjectArray()[j];
-			btRigidBody* body = btRigidBody::upcast(collisionObject);
-			btTransform trans;
+		btRigidBody::btRigidBodyConstructionInfo rbInfo(1, new btDefaultMotionState(transform), boxShape, localInertia);
+		scene.dynamicsWorld->addRigidBody(new btRigidBody(rbInfo));
+	}
 
-			if (body && body->getMotionState()) {
-				if (body->getMass() == 0) {
-					continue;
-				}
-				body->getMotionState()->getWorldTransform(trans);
+	scene.start.Save(scene.dynamicsWorld);
+	return scene;
+}
 
-				std::cout << trans.getOrigin().getY() << std::endl;
+// Full and empty are reported, and a million values pushed by one thread
+// arrive at the other whole and in order
+bool CheckSpscQueue() {
+	SpscQueue<int, 64> queue;
+	int value;
+	if (queue.TryPop(&value)) {
+		return false;
+	}
+	for (size_t i = 0; i < queue.GetCapacity(); i++) {
+		if (!queue.TryPush((int)i)) {
+			return false;
+		}
+	}
+	if (queue.TryPush(-1)) {
+		return false;
+	}
+	for (size_t i = 0; i < queue.GetCapacity(); i++) {
+		if (!queue.TryPop(&value) || value != (int)i) {
+			return false;
+		}
+	}
+
+	const int count = 1000000;
+	std::thread producer([&queue]() {
+		for (int i = 0; i < count; i++) {
+			while (!queue.TryPush(i)) {
+				std::this_thread::yield();
 			}
 		}
+	});
+
+	bool inOrder = true;
+	for (int expected = 0; expected < count; expected++) {
+		while (!queue.TryPop(&value)) {
+			std::this_thread::yield();
+		}
+		inOrder = inOrder && value == expected;
+	}
+	producer.join();
+	return inOrder && !queue.TryPop(&value);
+}
+
+// Average milliseconds per step
+double TimeSteps(Scene& scene) {
+	scene.start.Restore(scene.dynamicsWorld);
+	for (int i = 0; i < WARMUP_STEPS; i++) {
+		scene.dynamicsWorld->stepSimulation(1.0f / 60.0f, 0);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < TIMED_STEPS; i++) {
+		scene.dynamicsWorld->stepSimulation(1.0f / 60.0f, 0);
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count() / TIMED_STEPS;
+}
+
+int main(int argc, char** argv)
+{
+	int bodyCount = argc > 1 ? atoi(argv[1]) : 4000;
+	if (bodyCount <= 0) {
+		bodyCount = 4000;
+	}
+	if (!CheckSpscQueue()) {
+		printf("SpscQueue check failed\n");
+		return 1;
+	}
+	printf("SpscQueue check passed\n\n");
+
+	printf("%d boxes, %d steps after %d warmup steps\n\n", bodyCount, TIMED_STEPS, WARMUP_STEPS);
+
+	Scene singleThreaded = CreateScene(false, bodyCount);
+	double baseline = TimeSteps(singleThreaded);
+	printf("btDiscreteDynamicsWorld     %8.3f ms/step\n", baseline);
+
+	// Saving the settled pile, contacts and all, and putting it back
+	PhysicsSnapshot snapshot;
+	auto saveStart = std::chrono::high_resolution_clock::now();
+	snapshot.Save(singleThreaded.dynamicsWorld);
+	auto restoreStart = std::chrono::high_resolution_clock::now();
+	snapshot.Restore(singleThreaded.dynamicsWorld);
+	auto restoreEnd = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double, std::micro> saveTime = restoreStart - saveStart;
+	std::chrono::duration<double, std::micro> restoreTime = restoreEnd - restoreStart;
+	printf("PhysicsSnapshot             %8.1f us save   %8.1f us restore   %zu bytes\n\n", saveTime.count(), restoreTime.count(), snapshot.GetSize());
+
+	Scene multithreaded = CreateScene(true, bodyCount);
+	PhysicsTaskScheduler* scheduler = PhysicsTaskScheduler::GetInstance();
+	for (int threadCount = 1; threadCount <= scheduler->getMaxNumThreads(); threadCount++) {
+		scheduler->setNumThreads(threadCount);
+		double stepTime = TimeSteps(multithreaded);
+		printf("btDiscreteDynamicsWorldMt   %8.3f ms/step   %2d threads   %5.2fx\n", stepTime, threadCount, baseline / stepTime);
 	}
 
 	return 0;
-}
\ No newline at end of file
+}